@@ -0,0 +1,144 @@
+#include "Attacks.h"
+
+Bitboard BetweenTable[SQUARE_NB][SQUARE_NB];
+Bitboard LineTable[SQUARE_NB][SQUARE_NB];
+Magic BishopMagics[SQUARE_NB];
+Magic RookMagics[SQUARE_NB];
+
+// Shared attack storage: 5248 bishop and 102400 rook entries in total
+static Bitboard BishopTable[0x1480];
+static Bitboard RookTable[0x19000];
+
+static const int bishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+static const int rookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+static bool isOnBoard(int file, int rank) {
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+// Walk each ray until it leaves the board or hits a blocker. The blocker
+// itself is included, since it may be a capture.
+static Bitboard slidingAttacks(Square s, Bitboard occupied, const int (&directions)[4][2]) {
+    Bitboard attacks = 0;
+    for (const auto& direction : directions) {
+        int file = fileOf(s) + direction[0];
+        int rank = rankOf(s) + direction[1];
+        while (isOnBoard(file, rank)) {
+            Bitboard b = squareBB(makeSquare(file, rank));
+            attacks |= b;
+            if (occupied & b) {
+                break;
+            }
+            file += direction[0];
+            rank += direction[1];
+        }
+    }
+    return attacks;
+}
+
+// xorshift64* generator; a fixed seed keeps the magics identical on every run
+class MagicRandom {
+public:
+    explicit MagicRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    // Magics with few set bits are found much faster
+    uint64_t sparse() {
+        return next() & next() & next();
+    }
+
+private:
+    uint64_t state;
+};
+
+// Fill one slider's magic entries. For every square, all subsets of the
+// blocker mask are enumerated and a random magic is tried until it maps
+// each subset to a slot without a conflicting attack set.
+static void initMagics(Magic (&magics)[SQUARE_NB], Bitboard* table, const int (&directions)[4][2]) {
+    static Bitboard occupancy[4096];
+    static Bitboard reference[4096];
+#if !defined(USE_PEXT)
+    static int epoch[4096];
+    static int attempt = 0;
+    MagicRandom random(0x9E3779B97F4A7C15ULL);
+#endif
+
+    for (int i = 0; i < SQUARE_NB; ++i) {
+        Square s = Square(i);
+        Magic& m = magics[s];
+
+        // Edge squares never block a ray beyond them, so they stay out of the mask
+        Bitboard edges = ((RANK_1 | RANK_8) & ~rankBB(rankOf(s))) | ((FILE_A | FILE_H) & ~fileBB(fileOf(s)));
+        m.mask = slidingAttacks(s, 0, directions) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = i == 0 ? table : magics[i - 1].attacks + (1 << (64 - magics[i - 1].shift));
+
+        // Carry-rippler walk over every subset of the mask
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = slidingAttacks(s, b, directions);
+            ++size;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+#if defined(USE_PEXT)
+        // PEXT is a perfect hash of the mask bits, so no search is needed
+        for (int k = 0; k < size; ++k) {
+            m.attacks[m.index(occupancy[k])] = reference[k];
+        }
+#else
+        for (int found = 0; !found;) {
+            do {
+                m.magic = random.sparse();
+            } while (popCount((m.magic * m.mask) >> 56) < 6);
+
+            // Epochs mark which slots were written by the current attempt,
+            // which saves clearing the table between attempts
+            ++attempt;
+            found = 1;
+            for (int k = 0; k < size; ++k) {
+                unsigned idx = m.index(occupancy[k]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[k];
+                }
+                else if (m.attacks[idx] != reference[k]) {
+                    found = 0;
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+void initAttacks() {
+    initMagics(BishopMagics, BishopTable, bishopDirections);
+    initMagics(RookMagics, RookTable, rookDirections);
+
+    for (int i = 0; i < SQUARE_NB; ++i) {
+        for (int j = 0; j < SQUARE_NB; ++j) {
+            Square a = Square(i), b = Square(j);
+            BetweenTable[a][b] = LineTable[a][b] = 0;
+            if (a == b) {
+                continue;
+            }
+            if (bishopAttacks(a, 0) & squareBB(b)) {
+                LineTable[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | squareBB(a) | squareBB(b);
+                BetweenTable[a][b] = bishopAttacks(a, squareBB(b)) & bishopAttacks(b, squareBB(a));
+            }
+            else if (rookAttacks(a, 0) & squareBB(b)) {
+                LineTable[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | squareBB(a) | squareBB(b);
+                BetweenTable[a][b] = rookAttacks(a, squareBB(b)) & rookAttacks(b, squareBB(a));
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+
+#include "Bitboard.h"
+
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+// Attack sets for every piece type. Leaper tables are built by the compiler;
+// initAttacks() must run once at startup before the slider and line lookups
+// below are used.
+void initAttacks();
+
+typedef std::array<Bitboard, SQUARE_NB> AttackTable;
+
+constexpr int KnightDeltas[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+constexpr int KingDeltas[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+constexpr int WhitePawnDeltas[2][2] = { { -1, 1 }, { 1, 1 } };
+constexpr int BlackPawnDeltas[2][2] = { { -1, -1 }, { 1, -1 } };
+
+// One bitboard per origin square holding every on-board square reached by
+// the given file/rank steps
+template <int N>
+constexpr AttackTable makeStepTable(const int (&deltas)[N][2]) {
+    AttackTable table{};
+    for (int s = 0; s < SQUARE_NB; ++s) {
+        for (int i = 0; i < N; ++i) {
+            int file = s % 8 + deltas[i][0];
+            int rank = s / 8 + deltas[i][1];
+            if (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+                table[s] |= 1ULL << (rank * 8 + file);
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr AttackTable KnightAttackTable = makeStepTable(KnightDeltas);
+inline constexpr AttackTable KingAttackTable = makeStepTable(KingDeltas);
+inline constexpr AttackTable PawnAttackTable[COLOR_NB] = { makeStepTable(WhitePawnDeltas), makeStepTable(BlackPawnDeltas) };
+
+static_assert(KnightAttackTable[A1] == ((1ULL << B3) | (1ULL << C2)), "knight table");
+static_assert(KingAttackTable[H8] == ((1ULL << G8) | (1ULL << G7) | (1ULL << H7)), "king table");
+
+extern Bitboard BetweenTable[SQUARE_NB][SQUARE_NB];
+extern Bitboard LineTable[SQUARE_NB][SQUARE_NB];
+
+// Sliding attacks come from a single table lookup. The relevant occupancy
+// bits under the mask are hashed into an index, either by a magic multiply
+// and shift or, when built with USE_PEXT on a BMI2 machine, by a parallel
+// bit extract.
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+#if defined(USE_PEXT)
+        return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+        return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic BishopMagics[SQUARE_NB];
+extern Magic RookMagics[SQUARE_NB];
+
+constexpr Bitboard knightAttacks(Square s) {
+    return KnightAttackTable[s];
+}
+
+constexpr Bitboard kingAttacks(Square s) {
+    return KingAttackTable[s];
+}
+
+constexpr Bitboard pawnAttacks(Color c, Square s) {
+    return PawnAttackTable[c][s];
+}
+
+inline Bitboard bishopAttacks(Square s, Bitboard occupied) {
+    const Magic& m = BishopMagics[s];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard rookAttacks(Square s, Bitboard occupied) {
+    const Magic& m = RookMagics[s];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(Square s, Bitboard occupied) {
+    return bishopAttacks(s, occupied) | rookAttacks(s, occupied);
+}
+
+// Squares strictly between a and b, or nothing if they share no line
+inline Bitboard betweenBB(Square a, Square b) {
+    return BetweenTable[a][b];
+}
+
+// The whole rank, file or diagonal through a and b, or nothing if they share none
+inline Bitboard lineBB(Square a, Square b) {
+    return LineTable[a][b];
+}
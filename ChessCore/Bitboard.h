@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Types.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H = FILE_A << 7;
+constexpr Bitboard RANK_1 = 0xFFULL;
+constexpr Bitboard RANK_8 = RANK_1 << 56;
+constexpr Bitboard DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
+
+constexpr Bitboard fileBB(int file) {
+    return FILE_A << file;
+}
+
+constexpr Bitboard rankBB(int rank) {
+    return RANK_1 << (8 * rank);
+}
+
+constexpr Bitboard squareBB(Square s) {
+    return 1ULL << s;
+}
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least significant set bit. The bitboard must not be empty.
+inline Square lsb(Bitboard b) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return Square(index);
+#else
+    return Square(__builtin_ctzll(b));
+#endif
+}
+
+inline Square popLsb(Bitboard& b) {
+    Square s = lsb(b);
+    b &= b - 1;
+    return s;
+}
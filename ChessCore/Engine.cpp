@@ -0,0 +1,85 @@
+#include "Engine.h"
+
+#include <chrono>
+
+Engine::Engine(size_t hashMb, int threads)
+    : tt(hashMb), pool(tt, threads), bookRandom(Key(std::chrono::steady_clock::now().time_since_epoch().count())),
+      stopRequested(false), busy(false) {}
+
+Engine::~Engine() {
+    stop();
+    wait();
+}
+
+std::future<SearchResult> Engine::start(const Position& position, const SearchLimits& limits,
+    std::function<void(const SearchResult&)> onFinished) {
+    stop();
+    wait();
+
+    // The flag is reset here rather than on the worker so that a stop()
+    // arriving before the worker gets going is not lost
+    stopRequested.store(false, std::memory_order_relaxed);
+    busy.store(true, std::memory_order_release);
+
+    Move bookMove = limits.useBook && book.size() > 0 ? book.pick(position, splitMix64(bookRandom)) : NO_MOVE;
+    SearchLimits searchLimits = limits;
+    if (!searchLimits.tablebases && tables.maxPieces() > 0) {
+        searchLimits.tablebases = &tables;
+    }
+
+    std::promise<SearchResult> promise;
+    std::future<SearchResult> result = promise.get_future();
+    worker = std::thread([this, position, searchLimits, onFinished, bookMove, promise = std::move(promise)]() mutable {
+        SearchResult found;
+        if (bookMove != NO_MOVE) {
+            found.bestMove = bookMove;
+            found.pv.push_back(bookMove);
+        }
+        else {
+            found = pool.search(position, searchLimits, stopRequested);
+        }
+        if (onFinished) {
+            onFinished(found);
+        }
+        busy.store(false, std::memory_order_release);
+        promise.set_value(std::move(found));
+    });
+    return result;
+}
+
+void Engine::stop() {
+    stopRequested.store(true, std::memory_order_relaxed);
+}
+
+void Engine::wait() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void Engine::setThreads(int threads) {
+    wait();
+    pool.setThreads(threads);
+}
+
+void Engine::setHashSize(size_t megabytes) {
+    wait();
+    tt.resize(megabytes);
+}
+
+void Engine::clearHash() {
+    wait();
+    tt.clear();
+}
+
+bool Engine::loadBook(const std::string& path) {
+    wait();
+    book.close();
+    return path.empty() || book.open(path.c_str());
+}
+
+bool Engine::loadTablebases(const std::string& directory) {
+    wait();
+    tables.close();
+    return directory.empty() || tables.open(directory);
+}
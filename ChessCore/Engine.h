@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "Polyglot.h"
+#include "Search.h"
+
+// Runs searches on a background thread so the caller never blocks. A
+// search is started with a copy of the position, and its result arrives
+// through the returned future, the optional callback, or both. stop() ends
+// the search early with the best move found so far.
+//
+// With an opening book loaded, a position found in the book is answered
+// at once with a book move picked by weight, without searching. With
+// endgame tables loaded, every search probes them.
+class Engine {
+public:
+    Engine(size_t hashMb = 64, int threads = 1);
+    ~Engine();
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    // Begin searching, first stopping any search still running. The
+    // callback runs on the engine thread just before the future is ready.
+    std::future<SearchResult> start(const Position& position, const SearchLimits& limits,
+        std::function<void(const SearchResult&)> onFinished = nullptr);
+
+    bool thinking() const {
+        return busy.load(std::memory_order_acquire);
+    }
+
+    // Ask the running search to finish now. It still delivers a result.
+    void stop();
+
+    // Block until the running search, if any, has delivered its result
+    void wait();
+
+    // Only change these while no search is running
+    void setThreads(int threads);
+    void setHashSize(size_t megabytes);
+    void clearHash();
+
+    // Load a Polyglot book, or unload it when the path is empty. Returns
+    // false, leaving no book loaded, if the file cannot be opened.
+    bool loadBook(const std::string& path);
+
+    // Load the endgame tables of a directory, or unload them when the path
+    // is empty. Returns false, leaving none loaded, if the directory cannot
+    // be read or holds a damaged table.
+    bool loadTablebases(const std::string& directory);
+
+    // The loaded tables, for probing outside the search
+    const Tablebases& tablebases() const {
+        return tables;
+    }
+
+private:
+    TranspositionTable tt;
+    SearchPool pool;
+    OpeningBook book;
+    Key bookRandom;
+    Tablebases tables;
+    std::thread worker;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> busy;
+};
@@ -0,0 +1,116 @@
+#include "Evaluate.h"
+
+// Piece-square tables drawn as a white player sees the board, rank 8 on the
+// first row, so a white piece on square s reads entry s ^ 56 and a black
+// piece reads entry s directly.
+static const int PawnTable[SQUARE_NB] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     10,  10,  20,  30,  30,  20,  10,  10,
+      5,   5,  10,  25,  25,  10,   5,   5,
+      0,   0,   0,  20,  20,   0,   0,   0,
+      5,  -5, -10,   0,   0, -10,  -5,   5,
+      5,  10,  10, -20, -20,  10,  10,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+static const int KnightTable[SQUARE_NB] = {
+    -50, -40, -30, -30, -30, -30, -40, -50,
+    -40, -20,   0,   0,   0,   0, -20, -40,
+    -30,   0,  10,  15,  15,  10,   0, -30,
+    -30,   5,  15,  20,  20,  15,   5, -30,
+    -30,   0,  15,  20,  20,  15,   0, -30,
+    -30,   5,  10,  15,  15,  10,   5, -30,
+    -40, -20,   0,   5,   5,   0, -20, -40,
+    -50, -40, -30, -30, -30, -30, -40, -50,
+};
+
+static const int BishopTable[SQUARE_NB] = {
+    -20, -10, -10, -10, -10, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,  10,  10,   5,   0, -10,
+    -10,   5,   5,  10,  10,   5,   5, -10,
+    -10,   0,  10,  10,  10,  10,   0, -10,
+    -10,  10,  10,  10,  10,  10,  10, -10,
+    -10,   5,   0,   0,   0,   0,   5, -10,
+    -20, -10, -10, -10, -10, -10, -10, -20,
+};
+
+static const int RookTable[SQUARE_NB] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+      5,  10,  10,  10,  10,  10,  10,   5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+      0,   0,   0,   5,   5,   0,   0,   0,
+};
+
+static const int QueenTable[SQUARE_NB] = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+      0,   0,   5,   5,   5,   5,   0,  -5,
+    -10,   5,   5,   5,   5,   5,   0, -10,
+    -10,   0,   5,   0,   0,   0,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+};
+
+static const int KingMiddlegameTable[SQUARE_NB] = {
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -20, -30, -30, -40, -40, -30, -30, -20,
+    -10, -20, -20, -20, -20, -20, -20, -10,
+     20,  20,   0,   0,   0,   0,  20,  20,
+     20,  30,  10,   0,   0,  10,  30,  20,
+};
+
+static const int KingEndgameTable[SQUARE_NB] = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50,
+};
+
+static const int* const PieceTables[PIECE_TYPE_NB - 1] = {
+    PawnTable, KnightTable, BishopTable, RookTable, QueenTable
+};
+
+// Game phase runs from 24 with all minor and major pieces on the board down to 0
+static const int PhaseWeights[PIECE_TYPE_NB] = { 0, 1, 1, 2, 4, 0 };
+static const int MaxPhase = 24;
+
+int evaluate(const Position& position) {
+    int score[COLOR_NB] = { 0, 0 };
+    int phase = 0;
+
+    for (int c = WHITE; c <= BLACK; ++c) {
+        int flip = c == WHITE ? 56 : 0;
+        for (int pt = PAWN; pt < KING; ++pt) {
+            Bitboard b = position.pieces(Color(c), PieceType(pt));
+            phase += PhaseWeights[pt] * popCount(b);
+            while (b) {
+                Square s = popLsb(b);
+                score[c] += PieceValues[pt] + PieceTables[pt][s ^ flip];
+            }
+        }
+    }
+
+    // The king table is tapered on the total phase of both sides
+    int mg = phase > MaxPhase ? MaxPhase : phase;
+    for (int c = WHITE; c <= BLACK; ++c) {
+        int king = position.kingSquare(Color(c)) ^ (c == WHITE ? 56 : 0);
+        score[c] += (KingMiddlegameTable[king] * mg + KingEndgameTable[king] * (MaxPhase - mg)) / MaxPhase;
+    }
+
+    int white = score[WHITE] - score[BLACK];
+    return position.sideToMove() == WHITE ? white : -white;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Position.h"
+
+// Piece values in centipawns, indexed by PieceType
+const int PieceValues[PIECE_TYPE_NB] = { 100, 320, 330, 500, 900, 0 };
+
+// Static evaluation in centipawns from the point of view of the side to
+// move: material plus piece-square tables, with the king table blended
+// from middlegame to endgame as material comes off the board.
+int evaluate(const Position& position);
@@ -0,0 +1,58 @@
+#include "Game.h"
+
+Game::Game() {
+    reset();
+}
+
+void Game::reset() {
+    current.setStartPosition();
+    start = current;
+    moves.clear();
+    refreshLegalMoves();
+}
+
+bool Game::setFromFen(std::string_view fen) {
+    Position loaded;
+    if (!loaded.setFromFen(fen)) {
+        return false;
+    }
+    current = loaded;
+    start = loaded;
+    moves.clear();
+    refreshLegalMoves();
+    return true;
+}
+
+Move Game::findMove(Square from, Square to, PieceType promotion) const {
+    for (Move m : legal) {
+        if (moveFrom(m) == from && moveTo(m) == to && (!isPromotion(m) || promotionType(m) == promotion)) {
+            return m;
+        }
+    }
+    return NO_MOVE;
+}
+
+bool Game::playMove(Move m) {
+    if (!legal.contains(m)) {
+        return false;
+    }
+    current.makeMove(m);
+    moves.push_back(m);
+    refreshLegalMoves();
+    return true;
+}
+
+bool Game::undoMove() {
+    if (moves.empty() || current.undoDepth() == 0) {
+        return false;
+    }
+    current.unmakeMove();
+    moves.pop_back();
+    refreshLegalMoves();
+    return true;
+}
+
+void Game::refreshLegalMoves() {
+    legal.count = 0;
+    generateMoves(current, legal);
+}
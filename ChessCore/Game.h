@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "MoveGen.h"
+
+// A game in progress: the current position, the moves that led to it and
+// the legal replies. This is everything a front end needs to drive play,
+// with no dependency on any windowing library.
+class Game {
+public:
+    Game();
+
+    void reset();
+    bool setFromFen(std::string_view fen);
+
+    const Position& position() const {
+        return current;
+    }
+
+    // Position the game started from, before any of history()
+    const Position& startPosition() const {
+        return start;
+    }
+
+    Color sideToMove() const {
+        return current.sideToMove();
+    }
+
+    const MoveList& legalMoves() const {
+        return legal;
+    }
+
+    const std::vector<Move>& history() const {
+        return moves;
+    }
+
+    // The legal move between two squares, or NO_MOVE. A pawn reaching the
+    // last rank promotes to the given piece type.
+    Move findMove(Square from, Square to, PieceType promotion = QUEEN) const;
+
+    // Play a move if it is legal in the current position
+    bool playMove(Move m);
+
+    // Take back the last move played. Returns false at the start of the game.
+    bool undoMove();
+
+    bool inCheck() const {
+        return current.inCheck();
+    }
+
+    GameStatus status() const {
+        return positionStatus(current);
+    }
+
+private:
+    void refreshLegalMoves();
+
+    Position start;
+    Position current;
+    MoveList legal;
+    std::vector<Move> moves;
+};
@@ -0,0 +1,334 @@
+#include "GameArchive.h"
+
+#include <cstring>
+
+#include "MoveGen.h"
+
+static const char ArchiveMagic[4] = { 'C', 'G', 'A', 'R' };
+static const uint32_t ArchiveVersion = 1;
+
+static const char* const StandardStartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// The legal moves of a position, grouped by origin square with the set of
+// squares each piece can move to. A pawn move to the last rank stands for
+// four moves, one per promotion piece.
+//
+// Positions in check or with an en-passant capture are rare enough to be
+// taken from the full generator. Otherwise only pins and king safety
+// restrict the pieces, and a piece's targets come straight from the attack
+// tables when asked for, so decoding usually looks at a few pieces only.
+struct LegalTargets {
+    explicit LegalTargets(const Position& position)
+        : position(position), us(position.sideToMove()), occupied(position.occupied()),
+          ours(position.pieces(us)), enemies(position.pieces(~us)), king(position.kingSquare(us)),
+          generated(position.enPassantSquare() != NO_SQUARE || position.inCheck()) {
+        if (generated) {
+            MoveList moves;
+            generateMoves(position, moves);
+            std::memset(byOrigin, 0, sizeof(byOrigin));
+            for (Move m : moves) {
+                byOrigin[moveFrom(m)] |= squareBB(moveTo(m));
+            }
+        }
+        else {
+            pinned = position.pinnedPieces(us);
+        }
+    }
+
+    Bitboard of(Square from) const {
+        if (generated) {
+            return byOrigin[from];
+        }
+
+        Bitboard to = 0;
+        switch (typeOf(position.pieceOn(from))) {
+        case PAWN: {
+            int forward = us == WHITE ? 8 : -8;
+            Bitboard single = squareBB(Square(from + forward)) & ~occupied;
+            to = single | (pawnAttacks(us, from) & enemies);
+            if (single && rankOf(from) == (us == WHITE ? 1 : 6)) {
+                to |= squareBB(Square(from + 2 * forward)) & ~occupied;
+            }
+            break;
+        }
+        case KNIGHT:
+            to = knightAttacks(from) & ~ours;
+            break;
+        case BISHOP:
+            to = bishopAttacks(from, occupied) & ~ours;
+            break;
+        case ROOK:
+            to = rookAttacks(from, occupied) & ~ours;
+            break;
+        case QUEEN:
+            to = queenAttacks(from, occupied) & ~ours;
+            break;
+        default: {
+            Bitboard steps = kingAttacks(from) & ~ours;
+            while (steps) {
+                Square s = popLsb(steps);
+                if (!(position.attackersTo(s, occupied ^ squareBB(from)) & enemies)) {
+                    to |= squareBB(s);
+                }
+            }
+            if (position.castlingRights()) {
+                MoveList castles;
+                generateCastling(position, castles);
+                for (Move m : castles) {
+                    to |= squareBB(moveTo(m));
+                }
+            }
+            return to;
+        }
+        }
+        return pinned & squareBB(from) ? to & lineBB(king, from) : to;
+    }
+
+    // Number of moves a set of targets of the piece stands for
+    int count(Square from, Bitboard to) const {
+        Bitboard lastRanks = typeOf(position.pieceOn(from)) == PAWN ? RANK_1 | RANK_8 : 0;
+        return popCount(to) + 3 * popCount(to & lastRanks);
+    }
+
+    const Position& position;
+    Color us;
+    Bitboard occupied;
+    Bitboard ours;
+    Bitboard enemies;
+    Square king;
+    bool generated;
+    Bitboard pinned = 0;
+    Bitboard byOrigin[SQUARE_NB];
+};
+
+uint8_t encodeArchiveMove(const Position& position, Move m) {
+    LegalTargets targets(position);
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+
+    // Every move of the pieces ordered before this one, then of this piece
+    // to the squares before its destination
+    int index = 0;
+    Bitboard before = targets.ours & ~squareBB(targets.king);
+    if (from != targets.king) {
+        before &= squareBB(from) - 1;
+    }
+    while (before) {
+        Square s = popLsb(before);
+        index += targets.count(s, targets.of(s));
+    }
+    index += targets.count(from, targets.of(from) & (squareBB(to) - 1));
+    if (isPromotion(m)) {
+        index += promotionType(m) - KNIGHT;
+    }
+    return uint8_t(index);
+}
+
+Move decodeArchiveMove(const Position& position, uint8_t code) {
+    LegalTargets targets(position);
+
+    // The king comes after all the other pieces
+    int index = code;
+    Bitboard pieces = targets.ours & ~squareBB(targets.king);
+    Square from = NO_SQUARE;
+    Bitboard to = 0;
+    for (;;) {
+        if (!pieces) {
+            if (from == targets.king) {
+                return NO_MOVE;
+            }
+            from = targets.king;
+        }
+        else {
+            from = popLsb(pieces);
+        }
+        to = targets.of(from);
+        int moves = targets.count(from, to);
+        if (index < moves) {
+            break;
+        }
+        index -= moves;
+    }
+
+    // Walk the destinations of this piece to the one wanted
+    PieceType pt = typeOf(position.pieceOn(from));
+    Square target;
+    bool promotes;
+    for (;;) {
+        target = popLsb(to);
+        promotes = pt == PAWN && (rankOf(target) == 0 || rankOf(target) == 7);
+        int span = promotes ? 4 : 1;
+        if (index < span) {
+            break;
+        }
+        index -= span;
+    }
+
+    bool capture = !position.isEmpty(target);
+    int distance = int(target) - int(from);
+    if (promotes) {
+        return makeMove(from, target, (capture ? PROMOTION_CAPTURE : PROMOTION) + index);
+    }
+    if (pt == KING && (distance == 2 || distance == -2)) {
+        return makeMove(from, target, distance == 2 ? KING_CASTLE : QUEEN_CASTLE);
+    }
+    if (pt == PAWN && (distance == 16 || distance == -16)) {
+        return makeMove(from, target, DOUBLE_PUSH);
+    }
+    if (pt == PAWN && !capture && fileOf(from) != fileOf(target)) {
+        return makeMove(from, target, EN_PASSANT);
+    }
+    return makeMove(from, target, capture ? CAPTURE : QUIET);
+}
+
+GameArchiveWriter::~GameArchiveWriter() {
+    if (file) {
+        close();
+    }
+}
+
+bool GameArchiveWriter::open(const char* path) {
+    if (file) {
+        close();
+    }
+    file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    failed = false;
+    offsets.clear();
+
+    // Rewritten with the real counts by close()
+    ArchiveFileHeader header = {};
+    failed = std::fwrite(&header, sizeof(header), 1, file) != 1;
+    offset = sizeof(header);
+    return !failed;
+}
+
+bool GameArchiveWriter::add(const ArchiveGameHeader& info, const Position& start, const std::vector<Move>& moves) {
+    if (!file) {
+        return false;
+    }
+
+    char fen[Position::MAX_FEN_LENGTH];
+    size_t fenLength = start.writeFen(fen);
+    if (std::strcmp(fen, StandardStartFen) == 0) {
+        fenLength = 0;
+    }
+
+    Position position = start;
+    codes.clear();
+    for (Move m : moves) {
+        codes.push_back(encodeArchiveMove(position, m));
+        position.makeMove(m);
+    }
+
+    ArchiveGameHeader header = info;
+    header.plies = uint32_t(moves.size());
+    header.reserved = 0;
+    header.fenLength = uint16_t(fenLength);
+    offsets.push_back(offset);
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(fen, 1, fenLength, file) == fenLength
+        && std::fwrite(codes.data(), 1, codes.size(), file) == codes.size();
+    failed |= !ok;
+    offset += sizeof(header) + fenLength + codes.size();
+    return ok;
+}
+
+bool GameArchiveWriter::close() {
+    if (!file) {
+        return false;
+    }
+    ArchiveFileHeader header;
+    std::memcpy(header.magic, ArchiveMagic, sizeof(header.magic));
+    header.version = ArchiveVersion;
+    header.gameCount = offsets.size();
+    header.indexOffset = offset;
+
+    failed |= std::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), file) != offsets.size();
+    failed |= std::fseek(file, 0, SEEK_SET) != 0;
+    failed |= std::fwrite(&header, sizeof(header), 1, file) != 1;
+    failed |= std::fclose(file) != 0;
+    file = nullptr;
+    return !failed;
+}
+
+bool GameArchive::open(const char* path) {
+    close();
+    if (!file.open(path, RANDOM_ACCESS)) {
+        return false;
+    }
+
+    ArchiveFileHeader header;
+    if (file.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, ArchiveMagic, sizeof(header.magic)) != 0 || header.version != ArchiveVersion
+        || header.indexOffset < sizeof(header) || header.indexOffset > file.size()
+        || header.gameCount > (file.size() - header.indexOffset) / sizeof(uint64_t)) {
+        close();
+        return false;
+    }
+    gameCount = header.gameCount;
+    indexOffset = header.indexOffset;
+    return true;
+}
+
+void GameArchive::close() {
+    file.close();
+    gameCount = 0;
+    indexOffset = 0;
+}
+
+bool GameArchive::game(uint64_t number, ArchiveGame& out) const {
+    if (number >= gameCount) {
+        return false;
+    }
+    uint64_t offset;
+    std::memcpy(&offset, file.data() + indexOffset + number * sizeof(uint64_t), sizeof(offset));
+    if (offset < sizeof(ArchiveFileHeader) || offset > indexOffset || indexOffset - offset < sizeof(ArchiveGameHeader)) {
+        return false;
+    }
+    const char* record = file.data() + offset;
+    std::memcpy(&out.header, record, sizeof(out.header));
+    uint64_t length = sizeof(ArchiveGameHeader) + uint64_t(out.header.fenLength) + out.header.plies;
+    if (length > indexOffset - offset) {
+        return false;
+    }
+    out.fen = std::string_view(record + sizeof(ArchiveGameHeader), out.header.fenLength);
+    out.moves = reinterpret_cast<const uint8_t*>(record + sizeof(ArchiveGameHeader) + out.header.fenLength);
+    return true;
+}
+
+bool GameArchive::startPosition(const ArchiveGame& game, Position& position) {
+    if (game.fen.empty()) {
+        position.setStartPosition();
+        return true;
+    }
+    return position.setFromFen(game.fen);
+}
+
+bool GameArchive::replay(const ArchiveGame& game, Position& position, std::vector<Move>* moves) {
+    if (!startPosition(game, position)) {
+        return false;
+    }
+    if (moves) {
+        moves->clear();
+        moves->reserve(game.header.plies);
+    }
+    for (uint32_t ply = 0; ply < game.header.plies; ++ply) {
+        Move m = decodeArchiveMove(position, game.moves[ply]);
+        if (m == NO_MOVE) {
+            return false;
+        }
+        position.makeMove(m);
+        if (moves) {
+            moves->push_back(m);
+        }
+    }
+    return true;
+}
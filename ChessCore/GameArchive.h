@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Position.h"
+
+// Compact binary game records, opened by number straight from a memory
+// mapping with nothing to parse.
+//
+// File layout, integers in host byte order (little-endian on every
+// platform the project builds for):
+//   ArchiveFileHeader
+//   one record per game: ArchiveGameHeader, the start FEN if any, then one
+//     byte per ply, the index of the move among the legal moves of the
+//     position ordered by origin square with the king last, then by
+//     destination square, then by promotion piece from knight to queen
+//   the index: one uint64_t file offset per game, in game order
+//
+// The order is fixed by the rules rather than by the order the generator
+// happens to produce moves in, and no position has more than 218 legal
+// moves, so an index always fits in a byte.
+
+enum GameResult : uint8_t {
+    RESULT_UNKNOWN,
+    WHITE_WINS,
+    BLACK_WINS,
+    DRAWN
+};
+
+struct ArchiveFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t gameCount;
+    uint64_t indexOffset;
+};
+
+struct ArchiveGameHeader {
+    uint32_t plies;
+    // Date played as yyyymmdd, with unknown parts zero
+    uint32_t date;
+    uint16_t whiteElo;
+    uint16_t blackElo;
+    GameResult result;
+    uint8_t reserved;
+    // Length of the start FEN that follows, zero for the standard start
+    uint16_t fenLength;
+};
+
+static_assert(sizeof(ArchiveFileHeader) == 24, "archive file header layout");
+static_assert(sizeof(ArchiveGameHeader) == 16, "archive game header layout");
+
+// Byte for a legal move of the position, and the move a byte stands for
+// (NO_MOVE when the byte is out of range)
+uint8_t encodeArchiveMove(const Position& position, Move m);
+Move decodeArchiveMove(const Position& position, uint8_t code);
+
+// Appends games to a new archive file. Records go straight to disk; only
+// the offset index is held in memory until close() writes it out.
+class GameArchiveWriter {
+public:
+    GameArchiveWriter() = default;
+    ~GameArchiveWriter();
+
+    GameArchiveWriter(const GameArchiveWriter&) = delete;
+    GameArchiveWriter& operator=(const GameArchiveWriter&) = delete;
+
+    // Create or truncate the file. Returns false if it cannot be written.
+    bool open(const char* path);
+
+    // Append a game. The moves must be legal from the start position,
+    // whose FEN is stored only when it is not the standard start.
+    bool add(const ArchiveGameHeader& info, const Position& start, const std::vector<Move>& moves);
+
+    // Write the index and header. Returns false if any write failed.
+    bool close();
+
+private:
+    FILE* file = nullptr;
+    uint64_t offset = 0;
+    bool failed = false;
+    std::vector<uint64_t> offsets;
+    std::vector<uint8_t> codes;
+};
+
+// One game inside a mapped archive. Views stay valid while it is open.
+struct ArchiveGame {
+    ArchiveGameHeader header;
+    std::string_view fen;
+    const uint8_t* moves;
+};
+
+// Read-only view of an archive file through a memory mapping. Opening
+// checks the header and index bounds once; games are then found by a
+// single index lookup.
+class GameArchive {
+public:
+    bool open(const char* path);
+    void close();
+
+    uint64_t size() const {
+        return gameCount;
+    }
+
+    // Size of the whole file in bytes
+    uint64_t bytes() const {
+        return file.size();
+    }
+
+    // Game by number from zero. Returns false if the number is out of range
+    // or the record runs past the end of the records.
+    bool game(uint64_t number, ArchiveGame& out) const;
+
+    // Set up the start position of a game. Returns false on a bad FEN.
+    static bool startPosition(const ArchiveGame& game, Position& position);
+
+    // Replay a whole game, leaving the final position and, if wanted, the
+    // moves. Returns false if a move byte is out of range.
+    static bool replay(const ArchiveGame& game, Position& position, std::vector<Move>* moves = nullptr);
+
+private:
+    MappedFile file;
+    uint64_t gameCount = 0;
+    uint64_t indexOffset = 0;
+};
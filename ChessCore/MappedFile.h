@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// How a mapped file will be read, passed on to the operating system so it
+// reads ahead for a scan and does not for lookups that jump around
+enum FileAccess : uint8_t {
+    SEQUENTIAL_ACCESS,
+    RANDOM_ACCESS
+};
+
+// A whole file mapped read-only into memory. Pages are faulted in by the
+// operating system as they are touched, so a file of several gigabytes
+// can be scanned start to end without ever being read into a buffer.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the file, replacing any file mapped before. Returns false if it
+    // cannot be opened or mapped. An empty file maps to an empty view.
+    bool open(const char* path, FileAccess access);
+    void close();
+
+    const char* data() const {
+        return base;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    std::string_view text() const {
+        return std::string_view(base, length);
+    }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
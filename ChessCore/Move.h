@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Types.h"
+
+// A move packed into 16 bits: origin in bits 0-5, destination in bits 6-11
+// and a four-bit flag on top. Flag bit 2 marks captures and bit 3 marks
+// promotions, whose low two bits select the promoted piece.
+typedef uint16_t Move;
+
+const Move NO_MOVE = 0;
+const int MAX_MOVES = 256;
+
+enum MoveFlag {
+    QUIET = 0,
+    DOUBLE_PUSH = 1,
+    KING_CASTLE = 2,
+    QUEEN_CASTLE = 3,
+    CAPTURE = 4,
+    EN_PASSANT = 5,
+    PROMOTION = 8,
+    PROMOTION_CAPTURE = 12
+};
+
+constexpr Move makeMove(Square from, Square to, int flag = QUIET) {
+    return Move(from | (to << 6) | (flag << 12));
+}
+
+constexpr Square moveFrom(Move m) {
+    return Square(m & 63);
+}
+
+constexpr Square moveTo(Move m) {
+    return Square((m >> 6) & 63);
+}
+
+constexpr int moveFlag(Move m) {
+    return m >> 12;
+}
+
+constexpr bool isCapture(Move m) {
+    return (m & (CAPTURE << 12)) != 0;
+}
+
+constexpr bool isPromotion(Move m) {
+    return (m & (PROMOTION << 12)) != 0;
+}
+
+constexpr bool isCastling(Move m) {
+    return moveFlag(m) == KING_CASTLE || moveFlag(m) == QUEEN_CASTLE;
+}
+
+// Only meaningful when isPromotion(m) holds
+constexpr PieceType promotionType(Move m) {
+    return PieceType(KNIGHT + (moveFlag(m) & 3));
+}
+
+// Fixed-capacity move buffer meant to live on the stack. No legal chess
+// position has more than 218 moves, so MAX_MOVES can never overflow.
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int count = 0;
+
+    void add(Move m) {
+        moves[count++] = m;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    bool contains(Move m) const {
+        for (int i = 0; i < count; ++i) {
+            if (moves[i] == m) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Move* begin() {
+        return moves;
+    }
+
+    Move* end() {
+        return moves + count;
+    }
+
+    const Move* begin() const {
+        return moves;
+    }
+
+    const Move* end() const {
+        return moves + count;
+    }
+};
@@ -0,0 +1,290 @@
+#include "MoveGen.h"
+
+static void addPromotions(MoveList& moves, Square from, Square to, int flag) {
+    for (int piece = 3; piece >= 0; --piece) {
+        moves.add(makeMove(from, to, flag | piece));
+    }
+}
+
+static void addMoves(MoveList& moves, Square from, Bitboard targets, Bitboard enemies) {
+    while (targets) {
+        Square to = popLsb(targets);
+        moves.add(makeMove(from, to, (enemies & squareBB(to)) ? CAPTURE : QUIET));
+    }
+}
+
+static void addCastling(const Position& position, MoveList& moves, Color us) {
+    Color them = ~us;
+    Square kingFrom = us == WHITE ? E1 : E8;
+    if (position.pieceOn(kingFrom) != makePiece(us, KING) || position.isAttacked(kingFrom, them)) {
+        return;
+    }
+
+    int kingSide = us == WHITE ? WHITE_OO : BLACK_OO;
+    int queenSide = us == WHITE ? WHITE_OOO : BLACK_OOO;
+    Piece rook = makePiece(us, ROOK);
+    Bitboard occupied = position.occupied();
+
+    if ((position.castlingRights() & kingSide) && position.pieceOn(Square(kingFrom + 3)) == rook
+        && !(occupied & betweenBB(kingFrom, Square(kingFrom + 3)))
+        && !position.isAttacked(Square(kingFrom + 1), them) && !position.isAttacked(Square(kingFrom + 2), them)) {
+        moves.add(makeMove(kingFrom, Square(kingFrom + 2), KING_CASTLE));
+    }
+
+    if ((position.castlingRights() & queenSide) && position.pieceOn(Square(kingFrom - 4)) == rook
+        && !(occupied & betweenBB(kingFrom, Square(kingFrom - 4)))
+        && !position.isAttacked(Square(kingFrom - 1), them) && !position.isAttacked(Square(kingFrom - 2), them)) {
+        moves.add(makeMove(kingFrom, Square(kingFrom - 2), QUEEN_CASTLE));
+    }
+}
+
+// Captures mode keeps only captures, en passant and promotions, the moves a
+// quiescence search looks at
+template <bool Legal, bool Captures>
+static void generate(const Position& position, MoveList& moves) {
+    Color us = position.sideToMove();
+    Color them = ~us;
+    Bitboard ours = position.pieces(us);
+    // The enemy king is never a capture target, even in an illegal position
+    Bitboard enemies = position.pieces(them) & ~position.pieces(them, KING);
+    Bitboard occupied = position.occupied();
+    Square ksq = position.kingSquare(us);
+
+    Bitboard checkers = Legal ? position.checkers() : 0;
+    Bitboard pinned = Legal ? position.pinnedPieces(us) : 0;
+
+    // King steps, rejecting squares an enemy attacks once the king has left its square
+    Bitboard kingTargets = kingAttacks(ksq) & ~ours & ~position.pieces(them, KING);
+    if (Captures) {
+        kingTargets &= enemies;
+    }
+    Bitboard withoutKing = occupied ^ squareBB(ksq);
+    while (kingTargets) {
+        Square to = popLsb(kingTargets);
+        if (Legal && (position.attackersTo(to, withoutKing) & position.pieces(them))) {
+            continue;
+        }
+        moves.add(makeMove(ksq, to, (enemies & squareBB(to)) ? CAPTURE : QUIET));
+    }
+
+    // In double check only the king can move
+    if (checkers & (checkers - 1)) {
+        return;
+    }
+
+    // In single check other pieces must capture the checker or block its ray
+    Bitboard target = ~ours & ~position.pieces(them, KING);
+    if (checkers) {
+        target &= betweenBB(ksq, lsb(checkers)) | checkers;
+    }
+    // Pawn pushes keep the full target so that promotions survive captures mode
+    Bitboard pushTarget = target;
+    if (Captures) {
+        target &= enemies;
+    }
+
+    // A pinned knight can never move
+    Bitboard knights = position.pieces(us, KNIGHT) & ~pinned;
+    while (knights) {
+        Square from = popLsb(knights);
+        addMoves(moves, from, knightAttacks(from) & target, enemies);
+    }
+
+    // Pinned sliders may still move along the line of the pin
+    Bitboard bishops = position.pieces(us, BISHOP);
+    while (bishops) {
+        Square from = popLsb(bishops);
+        Bitboard attacks = bishopAttacks(from, occupied) & target;
+        if (pinned & squareBB(from)) {
+            attacks &= lineBB(ksq, from);
+        }
+        addMoves(moves, from, attacks, enemies);
+    }
+
+    Bitboard rooks = position.pieces(us, ROOK);
+    while (rooks) {
+        Square from = popLsb(rooks);
+        Bitboard attacks = rookAttacks(from, occupied) & target;
+        if (pinned & squareBB(from)) {
+            attacks &= lineBB(ksq, from);
+        }
+        addMoves(moves, from, attacks, enemies);
+    }
+
+    Bitboard queens = position.pieces(us, QUEEN);
+    while (queens) {
+        Square from = popLsb(queens);
+        Bitboard attacks = queenAttacks(from, occupied) & target;
+        if (pinned & squareBB(from)) {
+            attacks &= lineBB(ksq, from);
+        }
+        addMoves(moves, from, attacks, enemies);
+    }
+
+    int up = us == WHITE ? 8 : -8;
+    int startRank = us == WHITE ? 1 : 6;
+    int lastRank = us == WHITE ? 7 : 0;
+    Square epSquare = position.enPassantSquare();
+    Bitboard pawns = position.pieces(us, PAWN);
+    while (pawns) {
+        Square from = popLsb(pawns);
+        Bitboard pinMask = (pinned & squareBB(from)) ? lineBB(ksq, from) : ~0ULL;
+
+        // Pushes
+        Square one = Square(from + up);
+        if (!(occupied & squareBB(one)) && (!Captures || rankOf(one) == lastRank)) {
+            if (pushTarget & pinMask & squareBB(one)) {
+                if (rankOf(one) == lastRank) {
+                    addPromotions(moves, from, one, PROMOTION);
+                }
+                else {
+                    moves.add(makeMove(from, one, QUIET));
+                }
+            }
+            Square two = Square(one + up);
+            if (!Captures && rankOf(from) == startRank && !(occupied & squareBB(two))
+                && (pushTarget & pinMask & squareBB(two))) {
+                moves.add(makeMove(from, two, DOUBLE_PUSH));
+            }
+        }
+
+        // Captures
+        Bitboard captures = pawnAttacks(us, from) & enemies & target & pinMask;
+        while (captures) {
+            Square to = popLsb(captures);
+            if (rankOf(to) == lastRank) {
+                addPromotions(moves, from, to, PROMOTION_CAPTURE);
+            }
+            else {
+                moves.add(makeMove(from, to, CAPTURE));
+            }
+        }
+
+        // En passant removes two pawns from the board at once, which can expose
+        // the king along a rank, so legality is tested on the resulting occupancy
+        if (epSquare != NO_SQUARE && (pawnAttacks(us, from) & squareBB(epSquare))) {
+            Square captured = Square(epSquare - up);
+            if (Legal) {
+                Bitboard after = (occupied ^ squareBB(from) ^ squareBB(captured)) | squareBB(epSquare);
+                if (position.attackersTo(ksq, after) & position.pieces(them) & ~squareBB(captured)) {
+                    continue;
+                }
+            }
+            moves.add(makeMove(from, epSquare, EN_PASSANT));
+        }
+    }
+
+    if (!Captures && !checkers) {
+        addCastling(position, moves, us);
+    }
+}
+
+void generateMoves(const Position& position, MoveList& moves) {
+    generate<true, false>(position, moves);
+}
+
+void generatePseudoLegalMoves(const Position& position, MoveList& moves) {
+    generate<false, false>(position, moves);
+}
+
+void generateCaptures(const Position& position, MoveList& moves) {
+    generate<true, true>(position, moves);
+}
+
+void generateCastling(const Position& position, MoveList& moves) {
+    addCastling(position, moves, position.sideToMove());
+}
+
+bool hasLegalMove(const Position& position) {
+    Color us = position.sideToMove();
+    Color them = ~us;
+    Bitboard ours = position.pieces(us);
+    Bitboard enemies = position.pieces(them) & ~position.pieces(them, KING);
+    Bitboard occupied = position.occupied();
+    Square ksq = position.kingSquare(us);
+    Bitboard checkers = position.checkers();
+
+    // Other pieces first, as some of them can almost always move. In
+    // double check none of them can.
+    if (!(checkers & (checkers - 1))) {
+        Bitboard target = ~ours & ~position.pieces(them, KING);
+        if (checkers) {
+            target &= betweenBB(ksq, lsb(checkers)) | checkers;
+        }
+        Bitboard pinned = position.pinnedPieces(us);
+
+        Bitboard knights = position.pieces(us, KNIGHT) & ~pinned;
+        while (knights) {
+            if (knightAttacks(popLsb(knights)) & target) {
+                return true;
+            }
+        }
+
+        Bitboard diagonal = position.pieces(us, BISHOP) | position.pieces(us, QUEEN);
+        while (diagonal) {
+            Square from = popLsb(diagonal);
+            Bitboard attacks = bishopAttacks(from, occupied) & target;
+            if (attacks & ((pinned & squareBB(from)) ? lineBB(ksq, from) : ~0ULL)) {
+                return true;
+            }
+        }
+
+        Bitboard straight = position.pieces(us, ROOK) | position.pieces(us, QUEEN);
+        while (straight) {
+            Square from = popLsb(straight);
+            Bitboard attacks = rookAttacks(from, occupied) & target;
+            if (attacks & ((pinned & squareBB(from)) ? lineBB(ksq, from) : ~0ULL)) {
+                return true;
+            }
+        }
+
+        int up = us == WHITE ? 8 : -8;
+        int startRank = us == WHITE ? 1 : 6;
+        Bitboard pawns = position.pieces(us, PAWN);
+        while (pawns) {
+            Square from = popLsb(pawns);
+            Bitboard allowed = target & ((pinned & squareBB(from)) ? lineBB(ksq, from) : ~0ULL);
+            Square one = Square(from + up);
+            if (!(occupied & squareBB(one))) {
+                Square two = Square(one + up);
+                if ((allowed & squareBB(one))
+                    || (rankOf(from) == startRank && !(occupied & squareBB(two)) && (allowed & squareBB(two)))) {
+                    return true;
+                }
+            }
+            if (pawnAttacks(us, from) & enemies & allowed) {
+                return true;
+            }
+        }
+    }
+
+    // Castling is never the only move: it needs the king's first step to be free and safe
+    Bitboard kingTargets = kingAttacks(ksq) & ~ours & ~position.pieces(them, KING);
+    Bitboard withoutKing = occupied ^ squareBB(ksq);
+    while (kingTargets) {
+        if (!(position.attackersTo(popLsb(kingTargets), withoutKing) & position.pieces(them))) {
+            return true;
+        }
+    }
+
+    // En passant is too rare to be worth its own test
+    if (position.enPassantSquare() != NO_SQUARE) {
+        MoveList moves;
+        generateMoves(position, moves);
+        return moves.size() > 0;
+    }
+    return false;
+}
+
+GameStatus positionStatus(const Position& position) {
+    if (position.hasInsufficientMaterial()) {
+        return INSUFFICIENT_MATERIAL;
+    }
+    if (!hasLegalMove(position)) {
+        return position.inCheck() ? CHECKMATE : STALEMATE;
+    }
+    if (position.halfmoveClock() >= 100) {
+        return FIFTY_MOVE_DRAW;
+    }
+    return position.isRepetition(2) ? THREEFOLD_REPETITION : ONGOING;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Move.h"
+#include "Position.h"
+
+enum GameStatus {
+    ONGOING,
+    CHECKMATE,
+    STALEMATE,
+    FIFTY_MOVE_DRAW,
+    INSUFFICIENT_MATERIAL,
+    THREEFOLD_REPETITION
+};
+
+// Append every legal move of the side to move. Pins, check evasions,
+// castling through attacked squares and en-passant discoveries are all
+// resolved here, so the list never needs filtering afterwards.
+void generateMoves(const Position& position, MoveList& moves);
+
+// Append every move that obeys piece movement rules but may leave the
+// mover's own king in check.
+void generatePseudoLegalMoves(const Position& position, MoveList& moves);
+
+// Append the legal captures, en-passant captures and promotions only
+void generateCaptures(const Position& position, MoveList& moves);
+
+// Append the legal castling moves only
+void generateCastling(const Position& position, MoveList& moves);
+
+// Whether the side to move has any legal move. Stops at the first one,
+// working from the checkers and pinned pieces without building a list.
+bool hasLegalMove(const Position& position);
+
+// How the game stands in this position: checkmate or stalemate when there
+// is no legal move, a draw once the fifty-move rule applies, neither side
+// has the material left to mate or the position occurs for the third time,
+// and otherwise ongoing. Checkmate on the hundredth half-move still counts
+// as checkmate.
+GameStatus positionStatus(const Position& position);
@@ -0,0 +1,273 @@
+#include "Notation.h"
+
+#include "MoveGen.h"
+
+std::string squareName(Square s) {
+    return std::string{ char('a' + fileOf(s)), char('1' + rankOf(s)) };
+}
+
+std::string moveToUci(Move m) {
+    std::string text = squareName(moveFrom(m)) + squareName(moveTo(m));
+    if (isPromotion(m)) {
+        text += "nbrq"[promotionType(m) - KNIGHT];
+    }
+    return text;
+}
+
+Move moveFromUci(const Position& position, const std::string& text) {
+    MoveList moves;
+    generateMoves(position, moves);
+    for (Move m : moves) {
+        if (moveToUci(m) == text) {
+            return m;
+        }
+    }
+    return NO_MOVE;
+}
+
+static const char PieceLetters[PIECE_TYPE_NB] = { 'P', 'N', 'B', 'R', 'Q', 'K' };
+
+size_t writeSan(Position& position, Move m, char* out) {
+    char* p = out;
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    PieceType pt = typeOf(position.pieceOn(from));
+
+    if (moveFlag(m) == KING_CASTLE || moveFlag(m) == QUEEN_CASTLE) {
+        const char* text = moveFlag(m) == KING_CASTLE ? "O-O" : "O-O-O";
+        while (*text) {
+            *p++ = *text++;
+        }
+    }
+    else if (pt == PAWN) {
+        if (isCapture(m)) {
+            *p++ = char('a' + fileOf(from));
+            *p++ = 'x';
+        }
+        *p++ = char('a' + fileOf(to));
+        *p++ = char('1' + rankOf(to));
+        if (isPromotion(m)) {
+            *p++ = '=';
+            *p++ = PieceLetters[promotionType(m)];
+        }
+    }
+    else {
+        *p++ = PieceLetters[pt];
+
+        // Other pieces of the same type that could also legally reach the
+        // destination decide how much of the origin must be named
+        if (pt != KING) {
+            MoveList moves;
+            generateMoves(position, moves);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (Move other : moves) {
+                Square otherFrom = moveFrom(other);
+                if (moveTo(other) == to && otherFrom != from && position.pieceOn(otherFrom) == position.pieceOn(from)) {
+                    ambiguous = true;
+                    sameFile |= fileOf(otherFrom) == fileOf(from);
+                    sameRank |= rankOf(otherFrom) == rankOf(from);
+                }
+            }
+            if (ambiguous && (!sameFile || sameRank)) {
+                *p++ = char('a' + fileOf(from));
+            }
+            if (ambiguous && sameFile) {
+                *p++ = char('1' + rankOf(from));
+            }
+        }
+        if (isCapture(m)) {
+            *p++ = 'x';
+        }
+        *p++ = char('a' + fileOf(to));
+        *p++ = char('1' + rankOf(to));
+    }
+
+    position.makeMove(m);
+    if (position.inCheck()) {
+        MoveList replies;
+        generateMoves(position, replies);
+        *p++ = replies.size() == 0 ? '#' : '+';
+    }
+    position.unmakeMove();
+
+    *p = '\0';
+    return size_t(p - out);
+}
+
+std::string moveToSan(Position& position, Move m) {
+    char text[MAX_SAN_LENGTH];
+    size_t length = writeSan(position, m, text);
+    return std::string(text, length);
+}
+
+static bool isSanSuffix(char c) {
+    return c == '+' || c == '#' || c == '!' || c == '?';
+}
+
+static int sanPieceType(char c) {
+    switch (c) {
+    case 'N': return KNIGHT;
+    case 'B': return BISHOP;
+    case 'R': return ROOK;
+    case 'Q': return QUEEN;
+    case 'K': return KING;
+    default: return -1;
+    }
+}
+
+// Slow path for the moves the fast path does not prove legal by itself:
+// castling, en passant and everything while in check
+static Move findLegal(const Position& position, Move m) {
+    MoveList moves;
+    generateMoves(position, moves);
+    return moves.contains(m) ? m : NO_MOVE;
+}
+
+Move moveFromSan(const Position& position, std::string_view text) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    while (end > begin && isSanSuffix(end[-1])) {
+        --end;
+    }
+    size_t length = size_t(end - begin);
+    Color us = position.sideToMove();
+
+    if (length >= 3 && (begin[0] == 'O' || begin[0] == '0')) {
+        char o = begin[0];
+        bool kingSide = length == 3 && begin[1] == '-' && begin[2] == o;
+        bool queenSide = length == 5 && begin[1] == '-' && begin[2] == o && begin[3] == '-' && begin[4] == o;
+        if (!kingSide && !queenSide) {
+            return NO_MOVE;
+        }
+        Square king = us == WHITE ? E1 : E8;
+        Square target = Square(king + (kingSide ? 2 : -2));
+        return findLegal(position, makeMove(king, target, kingSide ? KING_CASTLE : QUEEN_CASTLE));
+    }
+
+    // Piece letter, optional origin file and rank, optional capture mark,
+    // destination square, then a promotion piece with or without '='
+    const char* p = begin;
+    int pt = PAWN;
+    if (p < end && sanPieceType(*p) >= 0) {
+        pt = sanPieceType(*p++);
+    }
+    int promotion = -1;
+    if (pt == PAWN && end - p >= 2 && sanPieceType(end[-1]) >= 0) {
+        promotion = sanPieceType(*--end);
+        if (end[-1] == '=') {
+            --end;
+        }
+        if (promotion == KING) {
+            return NO_MOVE;
+        }
+    }
+    if (end - p < 2 || end[-2] < 'a' || end[-2] > 'h' || end[-1] < '1' || end[-1] > '8') {
+        return NO_MOVE;
+    }
+    Square to = makeSquare(end[-2] - 'a', end[-1] - '1');
+    end -= 2;
+
+    Bitboard originMask = ~0ULL;
+    if (p < end && *p >= 'a' && *p <= 'h') {
+        originMask &= fileBB(*p++ - 'a');
+    }
+    if (p < end && *p >= '1' && *p <= '8') {
+        originMask &= rankBB(*p++ - '1');
+    }
+    if (p < end && (*p == 'x' || *p == ':')) {
+        ++p;
+    }
+    if (p != end) {
+        return NO_MOVE;
+    }
+
+    Bitboard occupied = position.occupied();
+    Bitboard ours = position.pieces(us);
+    if (ours & squareBB(to)) {
+        return NO_MOVE;
+    }
+    bool capture = !position.isEmpty(to);
+    int lastRank = us == WHITE ? 7 : 0;
+    if ((pt == PAWN && rankOf(to) == lastRank) != (promotion >= 0)) {
+        return NO_MOVE;
+    }
+
+    Bitboard origins;
+    int flag = capture ? CAPTURE : QUIET;
+    if (pt == PAWN) {
+        int forward = us == WHITE ? 8 : -8;
+        if (originMask != ~0ULL && (originMask & fileBB(fileOf(to))) == 0) {
+            // A capture names the file it starts from
+            origins = pawnAttacks(~us, to) & position.pieces(us, PAWN);
+            if (!capture) {
+                if (to != position.enPassantSquare()) {
+                    return NO_MOVE;
+                }
+                flag = EN_PASSANT;
+            }
+        }
+        else {
+            if (capture) {
+                return NO_MOVE;
+            }
+            Square one = Square(to - forward);
+            origins = position.pieces(us, PAWN) & squareBB(one);
+            int doubleRank = us == WHITE ? 3 : 4;
+            if (!origins && rankOf(to) == doubleRank && position.isEmpty(one)) {
+                origins = position.pieces(us, PAWN) & squareBB(Square(to - 2 * forward));
+                flag = DOUBLE_PUSH;
+            }
+        }
+        if (promotion >= 0) {
+            flag = (capture ? PROMOTION_CAPTURE : PROMOTION) + (promotion - KNIGHT);
+        }
+    }
+    else {
+        Bitboard attacks = pt == KNIGHT ? knightAttacks(to)
+            : pt == BISHOP ? bishopAttacks(to, occupied)
+            : pt == ROOK ? rookAttacks(to, occupied)
+            : pt == QUEEN ? queenAttacks(to, occupied)
+            : kingAttacks(to);
+        origins = attacks & position.pieces(us, PieceType(pt));
+    }
+    origins &= originMask;
+    if (!origins) {
+        return NO_MOVE;
+    }
+
+    if (flag == EN_PASSANT || position.inCheck()) {
+        Move found = NO_MOVE;
+        while (origins) {
+            Move m = findLegal(position, makeMove(popLsb(origins), to, flag));
+            if (m != NO_MOVE) {
+                if (found != NO_MOVE) {
+                    return NO_MOVE;
+                }
+                found = m;
+            }
+        }
+        return found;
+    }
+
+    // Not in check, a move is legal unless it walks the king into an
+    // attack or takes a pinned piece off the line to its king
+    Square king = position.kingSquare(us);
+    Bitboard pinned = position.pinnedPieces(us);
+    Move found = NO_MOVE;
+    while (origins) {
+        Square from = popLsb(origins);
+        if (pt == KING) {
+            if (position.attackersTo(to, occupied ^ squareBB(from)) & position.pieces(~us)) {
+                continue;
+            }
+        }
+        else if ((pinned & squareBB(from)) && !(lineBB(from, to) & squareBB(king))) {
+            continue;
+        }
+        if (found != NO_MOVE) {
+            return NO_MOVE;
+        }
+        found = makeMove(from, to, flag);
+    }
+    return found;
+}
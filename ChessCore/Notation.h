@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "Position.h"
+
+// Square name such as "e4"
+std::string squareName(Square s);
+
+// Long algebraic move as used by UCI, such as "e2e4" or "e7e8q"
+std::string moveToUci(Move m);
+
+// The legal move in the position written in long algebraic form, or
+// NO_MOVE when the text names no legal move
+Move moveFromUci(const Position& position, const std::string& text);
+
+// Longest move writeSan() can produce, such as "Qh4xe1+", terminator included
+const size_t MAX_SAN_LENGTH = 8;
+
+// Write a legal move in Standard Algebraic Notation, with the minimal
+// disambiguation and a check or mate suffix, into a buffer of at least
+// MAX_SAN_LENGTH characters, NUL-terminated, returning its length. The
+// move is made and taken back to test for check, so the position is
+// modified during the call but left as it was.
+size_t writeSan(Position& position, Move m, char* out);
+std::string moveToSan(Position& position, Move m);
+
+// The legal move named by a SAN token, or NO_MOVE when it names none or
+// is ambiguous. Check and annotation suffixes such as "+", "#" and "!?"
+// are ignored, over-disambiguated moves are accepted and castling may be
+// written with letter O or digit zero. Parsing never allocates.
+Move moveFromSan(const Position& position, std::string_view text);
@@ -0,0 +1,285 @@
+#include "Pgn.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Notation.h"
+
+static const char* const StandardStartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static const size_t PgnLineWidth = 80;
+
+static void writeTagValue(std::ostream& out, const std::string& value) {
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+}
+
+// Append a movetext token, starting a new line when it would not fit
+static void appendToken(std::ostream& out, std::string& line, const char* token, size_t length) {
+    if (!line.empty() && line.size() + 1 + length > PgnLineWidth) {
+        out << line << '\n';
+        line.clear();
+    }
+    if (!line.empty()) {
+        line += ' ';
+    }
+    line.append(token, length);
+}
+
+void writePgn(std::ostream& out, const std::vector<PgnTag>& tags, const Position& start,
+    const std::vector<Move>& moves, std::string_view result) {
+    for (const PgnTag& tag : tags) {
+        out << '[' << tag.name << " \"";
+        writeTagValue(out, tag.value);
+        out << "\"]\n";
+    }
+
+    char fen[Position::MAX_FEN_LENGTH];
+    start.writeFen(fen);
+    if (std::strcmp(fen, StandardStartFen) != 0) {
+        out << "[SetUp \"1\"]\n[FEN \"" << fen << "\"]\n";
+    }
+    out << '\n';
+
+    Position position = start;
+    std::string line;
+    char token[16];
+    bool first = true;
+    for (Move m : moves) {
+        if (position.sideToMove() == WHITE || first) {
+            int length = std::snprintf(token, sizeof(token), position.sideToMove() == WHITE ? "%d." : "%d...",
+                position.fullmoveNumber());
+            appendToken(out, line, token, size_t(length));
+        }
+        size_t length = writeSan(position, m, token);
+        appendToken(out, line, token, length);
+        position.makeMove(m);
+        first = false;
+    }
+    appendToken(out, line, result.data(), result.size());
+    out << line << "\n\n";
+}
+
+enum PgnToken {
+    TOKEN_MOVE,
+    TOKEN_RESULT,
+    TOKEN_END
+};
+
+static bool isPgnSpace(char c) {
+    return uint8_t(c) <= ' ';
+}
+
+static bool isPgnDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isTokenEnd(char c) {
+    return isPgnSpace(c) || c == '{' || c == '}' || c == '(' || c == ')' || c == '[' || c == ']' || c == ';'
+        || c == '$';
+}
+
+static bool isResult(std::string_view token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+PgnReader::PgnReader(std::string_view text)
+    : text(text), pos(0), gameStart(0), inMovetext(false), error(false), tagTotal(0) {
+}
+
+// Whitespace, brace and semicolon comments, and lines escaped with '%'
+void PgnReader::skipSpace() {
+    size_t size = text.size();
+    while (pos < size) {
+        char c = text[pos];
+        if (isPgnSpace(c)) {
+            ++pos;
+        }
+        else if (c == '{') {
+            size_t close = text.find('}', pos);
+            pos = close == std::string_view::npos ? size : close + 1;
+        }
+        else if (c == ';' || (c == '%' && (pos == 0 || text[pos - 1] == '\n'))) {
+            size_t newline = text.find('\n', pos);
+            pos = newline == std::string_view::npos ? size : newline + 1;
+        }
+        else {
+            break;
+        }
+    }
+}
+
+// Skip a parenthesised variation, with any nested inside it
+void PgnReader::skipVariation() {
+    int depth = 0;
+    size_t size = text.size();
+    while (pos < size) {
+        char c = text[pos];
+        if (c == '{' || c == ';') {
+            skipSpace();
+            continue;
+        }
+        ++pos;
+        if (c == '(') {
+            ++depth;
+        }
+        else if (c == ')' && --depth == 0) {
+            return;
+        }
+    }
+}
+
+// Tag pairs such as [White "Morphy, Paul"], each ending at ']' or the end
+// of its line. Malformed pairs are dropped.
+void PgnReader::readTags() {
+    tagTotal = 0;
+    size_t size = text.size();
+    for (skipSpace(); pos < size && text[pos] == '['; skipSpace()) {
+        size_t end = pos;
+        while (end < size && text[end] != '\n') {
+            ++end;
+        }
+        size_t p = pos + 1;
+        while (p < end && isPgnSpace(text[p])) {
+            ++p;
+        }
+        size_t nameStart = p;
+        while (p < end && !isPgnSpace(text[p]) && text[p] != '"' && text[p] != ']') {
+            ++p;
+        }
+        size_t nameEnd = p;
+        while (p < end && isPgnSpace(text[p])) {
+            ++p;
+        }
+        if (p < end && text[p] == '"' && nameEnd > nameStart) {
+            size_t valueStart = ++p;
+            while (p < end && text[p] != '"') {
+                p += text[p] == '\\' ? 2 : 1;
+            }
+            if (p < end && tagTotal < MAX_TAGS) {
+                tagNames[tagTotal] = text.substr(nameStart, nameEnd - nameStart);
+                tagValues[tagTotal] = text.substr(valueStart, p - valueStart);
+                ++tagTotal;
+            }
+        }
+        while (p < end && text[p] != ']') {
+            ++p;
+        }
+        pos = p < end ? p + 1 : end;
+    }
+}
+
+// Next SAN move or result token of the movetext, skipping move numbers,
+// annotation glyphs and variations. A '[' means the next game has begun
+// without a result.
+int PgnReader::readToken(std::string_view& token) {
+    size_t size = text.size();
+    for (;;) {
+        skipSpace();
+        if (pos >= size || text[pos] == '[') {
+            return TOKEN_END;
+        }
+
+        char c = text[pos];
+        if (c == '(') {
+            skipVariation();
+            continue;
+        }
+        if (c == '$' || c == '.') {
+            ++pos;
+            while (pos < size && (isPgnDigit(text[pos]) || text[pos] == '.')) {
+                ++pos;
+            }
+            continue;
+        }
+        if (isPgnDigit(c)) {
+            size_t p = pos;
+            while (p < size && isPgnDigit(text[p])) {
+                ++p;
+            }
+            if (p < size && text[p] == '.') {
+                pos = p;
+                continue;
+            }
+        }
+
+        size_t start = pos;
+        while (pos < size && !isTokenEnd(text[pos])) {
+            ++pos;
+        }
+        if (pos == start) {
+            // A stray ')', ']' or '}'
+            ++pos;
+            continue;
+        }
+        token = text.substr(start, pos - start);
+        if (c == '!' || c == '?') {
+            continue;
+        }
+        return isResult(token) ? TOKEN_RESULT : TOKEN_MOVE;
+    }
+}
+
+bool PgnReader::nextGame() {
+    if (inMovetext) {
+        std::string_view token;
+        while (readToken(token) == TOKEN_MOVE) {
+        }
+    }
+    inMovetext = false;
+
+    skipSpace();
+    if (pos >= text.size()) {
+        return false;
+    }
+    gameStart = pos;
+    error = false;
+    resultToken = std::string_view();
+    readTags();
+
+    std::string_view fen = tag("FEN");
+    if (fen.empty()) {
+        current.setStartPosition();
+    }
+    else if (!current.setFromFen(fen)) {
+        error = true;
+    }
+    inMovetext = true;
+    return true;
+}
+
+bool PgnReader::nextMove(Move& m) {
+    if (!inMovetext || error) {
+        return false;
+    }
+
+    std::string_view token;
+    int kind = readToken(token);
+    if (kind == TOKEN_MOVE) {
+        m = moveFromSan(current, token);
+        if (m == NO_MOVE) {
+            error = true;
+            return false;
+        }
+        current.makeMove(m);
+        return true;
+    }
+    if (kind == TOKEN_RESULT) {
+        resultToken = token;
+    }
+    inMovetext = false;
+    return false;
+}
+
+std::string_view PgnReader::tag(std::string_view name) const {
+    for (int i = 0; i < tagTotal; ++i) {
+        if (tagNames[i] == name) {
+            return tagValues[i];
+        }
+    }
+    return std::string_view();
+}
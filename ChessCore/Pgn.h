@@ -0,0 +1,101 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Position.h"
+
+struct PgnTag {
+    std::string name;
+    std::string value;
+};
+
+// Write one game in Portable Game Notation: the tag pairs in the order
+// given, SetUp and FEN tags when the start is not the standard position,
+// then the moves in SAN wrapped at 80 columns and the result ("1-0",
+// "0-1", "1/2-1/2" or "*"). The moves must be legal from the start.
+void writePgn(std::ostream& out, const std::vector<PgnTag>& tags, const Position& start,
+    const std::vector<Move>& moves, std::string_view result);
+
+// Streaming PGN reader over text already in memory, typically a
+// MappedFile. Games are read one at a time and moves one at a time, each
+// resolved against the legal moves of the position it is played in.
+// Comments, variations, numeric annotation glyphs, move numbers and
+// escaped lines are skipped. Nothing is copied or allocated: tag values
+// are views into the text, which must outlive the reader.
+//
+//   PgnReader reader(file.text());
+//   while (reader.nextGame()) {
+//       Move m;
+//       while (reader.nextMove(m)) { ... reader.position() ... }
+//   }
+class PgnReader {
+public:
+    explicit PgnReader(std::string_view text);
+
+    // Skip whatever is left of the current game and read the tag pairs of
+    // the next, setting up its starting position. Returns false at the end
+    // of the text.
+    bool nextGame();
+
+    // Play the next mainline move. Returns false at the end of the
+    // movetext, or when a move cannot be read or is not legal, in which
+    // case failed() is set and the rest of the game is skipped.
+    bool nextMove(Move& m);
+
+    // Value of a tag pair of the current game, empty if absent. Escaped
+    // quotes and backslashes are left as they appear in the text.
+    std::string_view tag(std::string_view name) const;
+
+    int tagCount() const {
+        return tagTotal;
+    }
+
+    std::string_view tagName(int i) const {
+        return tagNames[i];
+    }
+
+    std::string_view tagValue(int i) const {
+        return tagValues[i];
+    }
+
+    // Position after the moves read so far
+    const Position& position() const {
+        return current;
+    }
+
+    // Result token ending the movetext, known once nextMove() returns false
+    std::string_view result() const {
+        return resultToken;
+    }
+
+    bool failed() const {
+        return error;
+    }
+
+    // Byte offset of the current game in the text
+    size_t gameOffset() const {
+        return gameStart;
+    }
+
+private:
+    static const int MAX_TAGS = 32;
+
+    void skipSpace();
+    void skipVariation();
+    void readTags();
+    int readToken(std::string_view& token);
+
+    std::string_view text;
+    size_t pos;
+    size_t gameStart;
+    bool inMovetext;
+    bool error;
+    std::string_view resultToken;
+    int tagTotal;
+    std::string_view tagNames[MAX_TAGS];
+    std::string_view tagValues[MAX_TAGS];
+    Position current;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "MappedFile.h"
+#include "Position.h"
+
+// Opening books in the Polyglot .bin format: a file of 16-byte big-endian
+// entries (key, move, weight, learn) sorted by key, where the key is a
+// Zobrist hash of the position under Polyglot's own layout of 781 random
+// numbers, and a move packs the origin, destination and promotion piece
+// with castling written as the king taking its own rook.
+struct BookEntry {
+    Key key;
+    uint16_t move;
+    uint16_t weight;
+    uint32_t learn;
+};
+
+// Polyglot hash of the position, as written in books by other programs
+Key polyglotKey(const Position& position);
+
+// Convert between Polyglot move codes and legal moves of the position.
+// A code naming no legal move decodes to NO_MOVE.
+uint16_t moveToPolyglot(Move m);
+Move moveFromPolyglot(const Position& position, uint16_t code);
+
+// A book mapped into memory and searched by key with a binary search
+class OpeningBook {
+public:
+    bool open(const char* path);
+    void close();
+
+    size_t size() const {
+        return file.size() / ENTRY_BYTES;
+    }
+
+    // Book moves of the position, best weight first, up to max of them.
+    // Returns how many were found; entries naming no legal move are dropped.
+    int probe(const Position& position, BookEntry* out, int max) const;
+
+    // A book move picked at random in proportion to its weight, or NO_MOVE
+    // when the position is not in the book. random may be any 64-bit value.
+    Move pick(const Position& position, uint64_t random) const;
+
+    static const size_t ENTRY_BYTES = 16;
+    static const int MAX_BOOK_MOVES = 64;
+
+private:
+    BookEntry entry(size_t i) const;
+
+    MappedFile file;
+};
+
+// Build a book from the games of a PGN text, reading on the given number
+// of threads. Every move played in the first maxPly plies by at least
+// minGames games is kept, weighted by how it scored for the side playing
+// it: two points a win, one a draw. Returns false if the file cannot be
+// written.
+bool buildBook(std::string_view pgn, const char* path, int threads, int maxPly = 30, int minGames = 1);
@@ -0,0 +1,561 @@
+#include "Position.h"
+
+#include <algorithm>
+
+// Castling rights that survive a move touching each square. Moving the king
+// or a rook, or capturing a rook on its home square, drops the related rights.
+struct CastlingMasks {
+    uint8_t mask[SQUARE_NB];
+
+    constexpr CastlingMasks() : mask() {
+        for (int s = 0; s < SQUARE_NB; ++s) {
+            mask[s] = ALL_CASTLING;
+        }
+        mask[E1] = ALL_CASTLING & ~(WHITE_OO | WHITE_OOO);
+        mask[H1] = ALL_CASTLING & ~WHITE_OO;
+        mask[A1] = ALL_CASTLING & ~WHITE_OOO;
+        mask[E8] = ALL_CASTLING & ~(BLACK_OO | BLACK_OOO);
+        mask[H8] = ALL_CASTLING & ~BLACK_OO;
+        mask[A8] = ALL_CASTLING & ~BLACK_OOO;
+    }
+};
+
+static constexpr CastlingMasks castlingMasks;
+
+Position::Position() {
+    clear();
+}
+
+void Position::clear() {
+    for (Bitboard& b : pieceBB) {
+        b = 0;
+    }
+    colorBB[WHITE] = colorBB[BLACK] = 0;
+    occupiedBB = 0;
+    for (Piece& p : board) {
+        p = NO_PIECE;
+    }
+    side = WHITE;
+    castling = NO_CASTLING;
+    epSquare = NO_SQUARE;
+    halfmoves = 0;
+    fullmoves = 1;
+    hashKey = 0;
+    undoRing.clear();
+}
+
+void Position::setStartPosition() {
+    static const PieceType backRank[8] = { ROOK, KNIGHT, BISHOP, QUEEN, KING, BISHOP, KNIGHT, ROOK };
+
+    clear();
+    for (int file = 0; file < 8; ++file) {
+        putPiece(makePiece(WHITE, backRank[file]), makeSquare(file, 0));
+        putPiece(makePiece(WHITE, PAWN), makeSquare(file, 1));
+        putPiece(makePiece(BLACK, PAWN), makeSquare(file, 6));
+        putPiece(makePiece(BLACK, backRank[file]), makeSquare(file, 7));
+    }
+    castling = ALL_CASTLING;
+    hashKey = computeKey();
+}
+
+// How each character of a FEN placement field is handled: the piece it
+// puts down, how many squares it advances, and whether it is a rank
+// separator or not allowed at all
+struct FenChars {
+    Piece piece[256];
+    uint8_t advance[256];
+    bool slash[256];
+    bool invalid[256];
+
+    constexpr FenChars() : piece(), advance(), slash(), invalid() {
+        for (int c = 0; c < 256; ++c) {
+            piece[c] = NO_PIECE;
+            invalid[c] = true;
+        }
+        const char letters[] = "PNBRQKpnbrqk";
+        for (int i = 0; i < PIECE_NB; ++i) {
+            piece[uint8_t(letters[i])] = Piece(i);
+            advance[uint8_t(letters[i])] = 1;
+            invalid[uint8_t(letters[i])] = false;
+        }
+        for (int n = 1; n <= 8; ++n) {
+            advance['0' + n] = uint8_t(n);
+            invalid['0' + n] = false;
+        }
+        slash['/'] = true;
+        invalid['/'] = false;
+    }
+};
+
+static constexpr FenChars fenChars;
+
+// Spaces, tabs and line ends all separate fields; no FEN character sorts below a space
+static bool isFenSpace(char c) {
+    return uint8_t(c) <= ' ';
+}
+
+// Reads the next run of non-blank characters, returning false at the end of the text
+static bool nextField(const char*& p, const char* end, const char*& field, const char*& fieldEnd) {
+    while (p < end && isFenSpace(*p)) {
+        ++p;
+    }
+    field = p;
+    while (p < end && !isFenSpace(*p)) {
+        ++p;
+    }
+    fieldEnd = p;
+    return field != fieldEnd;
+}
+
+// A move counter field, saturating at the largest value the position stores
+static bool parseCounter(const char* field, const char* fieldEnd, uint16_t& value) {
+    uint32_t n = 0;
+    for (const char* c = field; c < fieldEnd; ++c) {
+        if (*c < '0' || *c > '9') {
+            return false;
+        }
+        n = n * 10 + uint32_t(*c - '0');
+        if (n > UINT16_MAX) {
+            n = UINT16_MAX;
+        }
+    }
+    value = uint16_t(n);
+    return true;
+}
+
+bool Position::setFromFen(std::string_view fen) {
+    clear();
+    if (!parseFen(fen)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+// Scans the text in place without building any strings, so that bulk loads
+// of FEN files are limited by memory bandwidth rather than the allocator
+bool Position::parseFen(std::string_view fen) {
+    const char* p = fen.data();
+    const char* end = p + fen.size();
+    const char* field;
+    const char* fieldEnd;
+
+    // Piece placement runs from a8 to h1, rank by rank. The characters are
+    // in no predictable order, so the loop avoids branching on them: every
+    // character is written through the tables and errors are accumulated
+    // into one flag that is tested at the end. Digits and separators store
+    // NO_PIECE on a square that is empty anyway, into a spare board slot.
+    if (!nextField(p, end, field, fieldEnd)) {
+        return false;
+    }
+    Bitboard placed[PIECE_NB + 1] = {};
+    int index = 0;
+    int ranksDone = 0;
+    bool bad = false;
+    for (const char* c = field; c < fieldEnd; ++c) {
+        uint8_t ch = uint8_t(*c);
+        bool slash = fenChars.slash[ch];
+        bad |= fenChars.invalid[ch] | (slash & (index != 8 * (ranksDone + 1)));
+        ranksDone += slash;
+
+        Square s = Square((index ^ 56) & 63);
+        Piece piece = fenChars.piece[ch];
+        board[s] = piece;
+        placed[piece] |= squareBB(s);
+
+        index += fenChars.advance[ch];
+        bad |= index > 8 * (ranksDone + 1);
+    }
+    if (bad || ranksDone != 7 || index != 64) {
+        return false;
+    }
+
+    for (int pc = 0; pc < PIECE_NB; ++pc) {
+        pieceBB[pc] = placed[pc];
+        colorBB[colorOf(Piece(pc))] |= placed[pc];
+        Bitboard b = placed[pc];
+        while (b) {
+            hashKey ^= Zobrist.pieceSquare[pc][popLsb(b)];
+        }
+    }
+    occupiedBB = colorBB[WHITE] | colorBB[BLACK];
+    // One king a side, and no pawn on a rank it can never stand on
+    if (popCount(pieces(WHITE, KING)) != 1 || popCount(pieces(BLACK, KING)) != 1
+        || ((placed[W_PAWN] | placed[B_PAWN]) & (RANK_1 | RANK_8))) {
+        return false;
+    }
+
+    if (!nextField(p, end, field, fieldEnd) || fieldEnd - field != 1 || (*field != 'w' && *field != 'b')) {
+        return false;
+    }
+    side = *field == 'w' ? WHITE : BLACK;
+
+    // The side that just moved cannot have left its king in check
+    if (attackersTo(kingSquare(~side), occupiedBB) & colorBB[side]) {
+        return false;
+    }
+
+    if (!nextField(p, end, field, fieldEnd)) {
+        return false;
+    }
+    for (const char* c = field; c < fieldEnd; ++c) {
+        switch (*c) {
+        case 'K': castling |= WHITE_OO; break;
+        case 'Q': castling |= WHITE_OOO; break;
+        case 'k': castling |= BLACK_OO; break;
+        case 'q': castling |= BLACK_OOO; break;
+        case '-': break;
+        default: return false;
+        }
+    }
+
+    if (!nextField(p, end, field, fieldEnd)) {
+        return false;
+    }
+    if (!(fieldEnd - field == 1 && *field == '-')) {
+        // The square the opponent's pawn skipped, so on the sixth rank when
+        // white is to move and on the third when black is
+        if (fieldEnd - field != 2 || field[0] < 'a' || field[0] > 'h' || field[1] != (side == WHITE ? '6' : '3')) {
+            return false;
+        }
+        // Keep the square only if the pawn that skipped it stands behind it
+        // on an empty path and one of ours can really capture onto it
+        Square s = makeSquare(field[0] - 'a', field[1] - '1');
+        int forward = side == WHITE ? 8 : -8;
+        Bitboard path = squareBB(s) | squareBB(Square(s + forward));
+        if ((pieces(~side, PAWN) & squareBB(Square(s - forward))) && !(occupiedBB & path)
+            && (pawnAttacks(~side, s) & pieces(side, PAWN))) {
+            epSquare = s;
+        }
+    }
+
+    // The move counters are optional, as in EPD records, and anything after them is ignored
+    if (nextField(p, end, field, fieldEnd)) {
+        if (!parseCounter(field, fieldEnd, halfmoves)) {
+            return false;
+        }
+        if (nextField(p, end, field, fieldEnd) && !parseCounter(field, fieldEnd, fullmoves)) {
+            return false;
+        }
+        if (fullmoves == 0) {
+            fullmoves = 1;
+        }
+    }
+
+    // The piece keys went in as the pieces were placed
+    hashKey ^= Zobrist.castling[castling];
+    if (epSquare != NO_SQUARE) {
+        hashKey ^= Zobrist.enPassant[fileOf(epSquare)];
+    }
+    if (side == BLACK) {
+        hashKey ^= Zobrist.side;
+    }
+    return true;
+}
+
+size_t Position::writeFen(char* out) const {
+    static const char pieceChars[] = "PNBRQKpnbrqk";
+    char* p = out;
+
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            Piece piece = board[makeSquare(file, rank)];
+            if (piece == NO_PIECE) {
+                ++empty;
+                continue;
+            }
+            if (empty > 0) {
+                *p++ = char('0' + empty);
+                empty = 0;
+            }
+            *p++ = pieceChars[piece];
+        }
+        if (empty > 0) {
+            *p++ = char('0' + empty);
+        }
+        *p++ = rank > 0 ? '/' : ' ';
+    }
+
+    *p++ = side == WHITE ? 'w' : 'b';
+    *p++ = ' ';
+    if (castling == NO_CASTLING) {
+        *p++ = '-';
+    }
+    if (castling & WHITE_OO) {
+        *p++ = 'K';
+    }
+    if (castling & WHITE_OOO) {
+        *p++ = 'Q';
+    }
+    if (castling & BLACK_OO) {
+        *p++ = 'k';
+    }
+    if (castling & BLACK_OOO) {
+        *p++ = 'q';
+    }
+    *p++ = ' ';
+    if (epSquare == NO_SQUARE) {
+        *p++ = '-';
+    }
+    else {
+        *p++ = char('a' + fileOf(epSquare));
+        *p++ = char('1' + rankOf(epSquare));
+    }
+
+    for (unsigned counter : { unsigned(halfmoves), unsigned(fullmoves) }) {
+        *p++ = ' ';
+        char digits[5];
+        int count = 0;
+        do {
+            digits[count++] = char('0' + counter % 10);
+            counter /= 10;
+        } while (counter > 0);
+        while (count > 0) {
+            *p++ = digits[--count];
+        }
+    }
+    *p = '\0';
+    return size_t(p - out);
+}
+
+std::string Position::fen() const {
+    char buffer[MAX_FEN_LENGTH];
+    return std::string(buffer, writeFen(buffer));
+}
+
+void Position::putPiece(Piece piece, Square s) {
+    Bitboard b = squareBB(s);
+    board[s] = piece;
+    hashKey ^= Zobrist.pieceSquare[piece][s];
+    pieceBB[piece] |= b;
+    colorBB[colorOf(piece)] |= b;
+    occupiedBB |= b;
+}
+
+void Position::removePiece(Square s) {
+    Piece piece = board[s];
+    Bitboard b = squareBB(s);
+    board[s] = NO_PIECE;
+    hashKey ^= Zobrist.pieceSquare[piece][s];
+    pieceBB[piece] &= ~b;
+    colorBB[colorOf(piece)] &= ~b;
+    occupiedBB &= ~b;
+}
+
+void Position::movePiece(Square from, Square to) {
+    Piece piece = board[from];
+    Bitboard fromTo = squareBB(from) | squareBB(to);
+    board[from] = NO_PIECE;
+    board[to] = piece;
+    hashKey ^= Zobrist.pieceSquare[piece][from] ^ Zobrist.pieceSquare[piece][to];
+    pieceBB[piece] ^= fromTo;
+    colorBB[colorOf(piece)] ^= fromTo;
+    occupiedBB ^= fromTo;
+}
+
+// Pieces of both colours attacking a square, with sliders blocked by the given occupancy
+Bitboard Position::attackersTo(Square s, Bitboard occupancy) const {
+    Bitboard bishopsQueens = pieceBB[W_BISHOP] | pieceBB[B_BISHOP] | pieceBB[W_QUEEN] | pieceBB[B_QUEEN];
+    Bitboard rooksQueens = pieceBB[W_ROOK] | pieceBB[B_ROOK] | pieceBB[W_QUEEN] | pieceBB[B_QUEEN];
+    return (pawnAttacks(BLACK, s) & pieceBB[W_PAWN])
+        | (pawnAttacks(WHITE, s) & pieceBB[B_PAWN])
+        | (knightAttacks(s) & (pieceBB[W_KNIGHT] | pieceBB[B_KNIGHT]))
+        | (kingAttacks(s) & (pieceBB[W_KING] | pieceBB[B_KING]))
+        | (bishopAttacks(s, occupancy) & bishopsQueens)
+        | (rookAttacks(s, occupancy) & rooksQueens);
+}
+
+// Pieces of colour c that are the only blocker between their king and an enemy slider
+Bitboard Position::pinnedPieces(Color c) const {
+    Square ksq = kingSquare(c);
+    Color them = ~c;
+    Bitboard snipers = (rookAttacks(ksq, 0) & (pieces(them, ROOK) | pieces(them, QUEEN)))
+        | (bishopAttacks(ksq, 0) & (pieces(them, BISHOP) | pieces(them, QUEEN)));
+    Bitboard pinned = 0;
+    while (snipers) {
+        Bitboard blockers = betweenBB(ksq, popLsb(snipers)) & occupiedBB;
+        if (blockers && !(blockers & (blockers - 1))) {
+            pinned |= blockers & colorBB[c];
+        }
+    }
+    return pinned;
+}
+
+bool Position::hasInsufficientMaterial() const {
+    if (pieceBB[W_PAWN] | pieceBB[B_PAWN] | pieceBB[W_ROOK] | pieceBB[B_ROOK] | pieceBB[W_QUEEN] | pieceBB[B_QUEEN]) {
+        return false;
+    }
+    Bitboard bishops = pieceBB[W_BISHOP] | pieceBB[B_BISHOP];
+    Bitboard minors = bishops | pieceBB[W_KNIGHT] | pieceBB[B_KNIGHT];
+    if (!(minors & (minors - 1))) {
+        return true;
+    }
+    return minors == bishops && (!(bishops & DARK_SQUARES) || !(bishops & ~DARK_SQUARES));
+}
+
+void Position::makeMove(Move m) {
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    Color us = side;
+    int flag = moveFlag(m);
+
+    UndoRecord& undo = undoRing.push();
+    undo.move = m;
+    undo.captured = flag == EN_PASSANT ? makePiece(~us, PAWN) : board[to];
+    undo.castling = castling;
+    undo.epSquare = epSquare;
+    undo.halfmoves = halfmoves;
+    undo.key = hashKey;
+
+    ++halfmoves;
+    if (typeOf(board[from]) == PAWN || isCapture(m)) {
+        halfmoves = 0;
+    }
+
+    if (flag == EN_PASSANT) {
+        // The captured pawn sits beside the origin, on the destination's file
+        removePiece(Square(to ^ 8));
+    }
+    else if (isCapture(m)) {
+        removePiece(to);
+    }
+
+    movePiece(from, to);
+
+    if (isPromotion(m)) {
+        removePiece(to);
+        putPiece(makePiece(us, promotionType(m)), to);
+    }
+    else if (flag == KING_CASTLE) {
+        movePiece(Square(to + 1), Square(to - 1));
+    }
+    else if (flag == QUEEN_CASTLE) {
+        movePiece(Square(to - 2), Square(to + 1));
+    }
+
+    // Only record an en-passant square when an enemy pawn can actually use it
+    if (epSquare != NO_SQUARE) {
+        hashKey ^= Zobrist.enPassant[fileOf(epSquare)];
+        epSquare = NO_SQUARE;
+    }
+    if (flag == DOUBLE_PUSH) {
+        Square passed = Square((from + to) / 2);
+        if (pawnAttacks(us, passed) & pieces(~us, PAWN)) {
+            epSquare = passed;
+            hashKey ^= Zobrist.enPassant[fileOf(passed)];
+        }
+    }
+
+    uint8_t rights = castling & castlingMasks.mask[from] & castlingMasks.mask[to];
+    if (rights != castling) {
+        hashKey ^= Zobrist.castling[castling] ^ Zobrist.castling[rights];
+        castling = rights;
+    }
+
+    if (us == BLACK) {
+        ++fullmoves;
+    }
+    side = ~us;
+    hashKey ^= Zobrist.side;
+}
+
+void Position::unmakeMove() {
+    const UndoRecord& undo = undoRing.pop();
+
+    Move m = undo.move;
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    Color us = ~side;
+    int flag = moveFlag(m);
+
+    if (isPromotion(m)) {
+        removePiece(to);
+        putPiece(makePiece(us, PAWN), to);
+    }
+    else if (flag == KING_CASTLE) {
+        movePiece(Square(to - 1), Square(to + 1));
+    }
+    else if (flag == QUEEN_CASTLE) {
+        movePiece(Square(to + 1), Square(to - 2));
+    }
+
+    movePiece(to, from);
+
+    if (flag == EN_PASSANT) {
+        putPiece(undo.captured, Square(to ^ 8));
+    }
+    else if (isCapture(m)) {
+        putPiece(undo.captured, to);
+    }
+
+    // The piece moves above toggled the key; the saved one replaces it wholesale
+    castling = undo.castling;
+    epSquare = undo.epSquare;
+    halfmoves = undo.halfmoves;
+    hashKey = undo.key;
+    if (us == BLACK) {
+        --fullmoves;
+    }
+    side = us;
+}
+
+bool Position::isRepetition(int times) const {
+    int limit = std::min(int(halfmoves), undoRing.size());
+    int found = 0;
+    for (int back = 2; back <= limit; back += 2) {
+        const UndoRecord& reply = undoRing.back(back - 1);
+        const UndoRecord& earlier = undoRing.back(back);
+        if (reply.move == NO_MOVE || earlier.move == NO_MOVE) {
+            return false;
+        }
+        if (earlier.key == hashKey && ++found >= times) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Position::makeNullMove() {
+    UndoRecord& undo = undoRing.push();
+    undo.move = NO_MOVE;
+    undo.captured = NO_PIECE;
+    undo.castling = castling;
+    undo.epSquare = epSquare;
+    undo.halfmoves = halfmoves;
+    undo.key = hashKey;
+
+    ++halfmoves;
+    if (epSquare != NO_SQUARE) {
+        hashKey ^= Zobrist.enPassant[fileOf(epSquare)];
+        epSquare = NO_SQUARE;
+    }
+    side = ~side;
+    hashKey ^= Zobrist.side;
+}
+
+void Position::unmakeNullMove() {
+    const UndoRecord& undo = undoRing.pop();
+
+    epSquare = undo.epSquare;
+    halfmoves = undo.halfmoves;
+    hashKey = undo.key;
+    side = ~side;
+}
+
+Key Position::computeKey() const {
+    Key k = 0;
+    for (int s = 0; s < SQUARE_NB; ++s) {
+        if (board[s] != NO_PIECE) {
+            k ^= Zobrist.pieceSquare[board[s]][s];
+        }
+    }
+    k ^= Zobrist.castling[castling];
+    if (epSquare != NO_SQUARE) {
+        k ^= Zobrist.enPassant[fileOf(epSquare)];
+    }
+    if (side == BLACK) {
+        k ^= Zobrist.side;
+    }
+    return k;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "Attacks.h"
+#include "Move.h"
+#include "Zobrist.h"
+
+// Everything makeMove() destroys and unmakeMove() needs to put back
+struct UndoRecord {
+    Move move;
+    Piece captured;
+    uint8_t castling;
+    Square epSquare;
+    uint16_t halfmoves;
+    Key key;
+};
+
+// A chess position stored as one bitboard per piece plus occupancy masks.
+// A mailbox array mirrors the bitboards so the piece on a square can be read
+// without scanning all twelve boards.
+//
+// Moves are made and unmade in place. Each makeMove() pushes an UndoRecord
+// onto a fixed ring inside the position, so only the most recent
+// UNDO_CAPACITY moves can be taken back. Copying a position copies the
+// board and only the records in use, never the whole ring.
+class Position {
+public:
+    Position();
+
+    void clear();
+    void setStartPosition();
+
+    // Load a position from Forsyth-Edwards Notation. Returns false, leaving
+    // the position cleared, when the text is not a valid FEN record. The
+    // move counters may be left off, as in EPD. Parsing never allocates.
+    bool setFromFen(std::string_view fen);
+
+    // Longest FEN record writeFen() can produce, terminator included
+    static const size_t MAX_FEN_LENGTH = 96;
+
+    // Write the position as FEN into a buffer of at least MAX_FEN_LENGTH
+    // characters, NUL-terminated, returning its length. The en-passant
+    // square appears only when a capture onto it is possible.
+    size_t writeFen(char* out) const;
+    std::string fen() const;
+
+    void putPiece(Piece piece, Square s);
+    void removePiece(Square s);
+    void movePiece(Square from, Square to);
+
+    static const int UNDO_CAPACITY = 1024;
+
+    // Play a move produced by the move generator for the side to move
+    void makeMove(Move m);
+
+    // Take back the most recent move made with makeMove()
+    void unmakeMove();
+
+    // Pass the turn without moving, for null-move pruning. Never call it
+    // while in check; take it back with unmakeNullMove().
+    void makeNullMove();
+    void unmakeNullMove();
+
+    // Number of moves that unmakeMove() can currently take back
+    int undoDepth() const {
+        return undoRing.size();
+    }
+
+    // Whether the position occurred at least the given number of times
+    // before. Keys are read back from the undo ring to the last capture or
+    // pawn move, which nothing can repeat across, comparing only every
+    // other one since the side to move must match. A null move also ends
+    // the scan, as the search's passes are not moves of the game.
+    bool isRepetition(int times = 1) const;
+
+    Piece pieceOn(Square s) const {
+        return board[s];
+    }
+
+    bool isEmpty(Square s) const {
+        return board[s] == NO_PIECE;
+    }
+
+    Bitboard pieces(Piece piece) const {
+        return pieceBB[piece];
+    }
+
+    Bitboard pieces(Color c, PieceType pt) const {
+        return pieceBB[makePiece(c, pt)];
+    }
+
+    Bitboard pieces(Color c) const {
+        return colorBB[c];
+    }
+
+    Bitboard occupied() const {
+        return occupiedBB;
+    }
+
+    Square kingSquare(Color c) const {
+        return lsb(pieces(c, KING));
+    }
+
+    Bitboard attackersTo(Square s, Bitboard occupancy) const;
+    Bitboard pinnedPieces(Color c) const;
+
+    bool isAttacked(Square s, Color by) const {
+        return (attackersTo(s, occupiedBB) & colorBB[by]) != 0;
+    }
+
+    Bitboard checkers() const {
+        return attackersTo(kingSquare(side), occupiedBB) & colorBB[~side];
+    }
+
+    bool inCheck() const {
+        return checkers() != 0;
+    }
+
+    // Whether neither side can ever mate: bare kings, a single minor piece,
+    // or bishops that all stand on squares of one colour
+    bool hasInsufficientMaterial() const;
+
+    // Zobrist key, kept up to date by every change to the position
+    Key key() const {
+        return hashKey;
+    }
+
+    // Key recomputed from scratch, for verifying the incremental one
+    Key computeKey() const;
+
+    Color sideToMove() const {
+        return side;
+    }
+
+    void setSideToMove(Color c) {
+        if (c != side) {
+            hashKey ^= Zobrist.side;
+        }
+        side = c;
+    }
+
+    int castlingRights() const {
+        return castling;
+    }
+
+    Square enPassantSquare() const {
+        return epSquare;
+    }
+
+    int halfmoveClock() const {
+        return halfmoves;
+    }
+
+    int fullmoveNumber() const {
+        return fullmoves;
+    }
+
+private:
+    bool parseFen(std::string_view fen);
+
+    Bitboard pieceBB[PIECE_NB];
+    Bitboard colorBB[COLOR_NB];
+    Bitboard occupiedBB;
+    Piece board[SQUARE_NB];
+    Color side;
+    uint8_t castling;
+    Square epSquare;
+    uint16_t halfmoves;
+    uint16_t fullmoves;
+    Key hashKey;
+
+    // Undo records of the most recent moves, oldest overwritten first
+    class UndoRing {
+    public:
+        UndoRing() = default;
+
+        UndoRing(const UndoRing& other) {
+            *this = other;
+        }
+
+        UndoRing& operator=(const UndoRing& other) {
+            count = other.count;
+            top = other.top;
+            for (uint32_t i = top - uint32_t(count); i != top; ++i) {
+                records[i & (UNDO_CAPACITY - 1)] = other.records[i & (UNDO_CAPACITY - 1)];
+            }
+            return *this;
+        }
+
+        // The record of a new move, overwriting the oldest when the ring is full
+        UndoRecord& push() {
+            if (count < UNDO_CAPACITY) {
+                ++count;
+            }
+            return records[top++ & (UNDO_CAPACITY - 1)];
+        }
+
+        const UndoRecord& pop() {
+            --count;
+            return records[--top & (UNDO_CAPACITY - 1)];
+        }
+
+        // The record pushed the given number of moves ago, 1 being the last
+        const UndoRecord& back(int moves) const {
+            return records[(top - uint32_t(moves)) & (UNDO_CAPACITY - 1)];
+        }
+
+        int size() const {
+            return count;
+        }
+
+        void clear() {
+            count = 0;
+            top = 0;
+        }
+
+    private:
+        int count = 0;
+        uint32_t top = 0;
+        UndoRecord records[UNDO_CAPACITY];
+    };
+
+    UndoRing undoRing;
+};
@@ -0,0 +1,318 @@
+#include "PositionIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <thread>
+#include <vector>
+
+static const char IndexMagic[4] = { 'C', 'P', 'I', 'X' };
+static const uint32_t IndexVersion = 1;
+
+// One position reached in one game, and the move the game went on with
+// (NO_MOVE where it ended)
+struct Occurrence {
+    Key key;
+    uint32_t game;
+    Move move;
+    GameResult result;
+
+    bool operator<(const Occurrence& other) const {
+        if (key != other.key) {
+            return key < other.key;
+        }
+        if (game != other.game) {
+            return game < other.game;
+        }
+        return move < other.move;
+    }
+};
+
+static size_t padTo8(size_t bytes) {
+    return (bytes + 7) & ~size_t(7);
+}
+
+// Directory size for a table of the given length: about eight positions
+// per bucket, so a lookup ends inside one or two cache lines
+static uint32_t chooseBucketBits(uint64_t positions) {
+    uint32_t bits = 1;
+    while (bits < 24 && (uint64_t(1) << (bits + 3)) < positions) {
+        ++bits;
+    }
+    return bits;
+}
+
+static bool collect(const GameArchive& archive, uint64_t first, uint64_t last, int maxPly, std::vector<Occurrence>& out) {
+    Position position;
+    ArchiveGame game;
+    for (uint64_t number = first; number < last; ++number) {
+        if (!archive.game(number, game) || !GameArchive::startPosition(game, position)) {
+            return false;
+        }
+        uint32_t plies = game.header.plies;
+        if (maxPly > 0 && plies > uint32_t(maxPly)) {
+            plies = uint32_t(maxPly);
+        }
+        for (uint32_t ply = 0; ply <= plies; ++ply) {
+            Move m = ply < plies ? decodeArchiveMove(position, game.moves[ply]) : NO_MOVE;
+            if (ply < plies && m == NO_MOVE) {
+                return false;
+            }
+            out.push_back({ position.key(), uint32_t(number), m, game.header.result });
+            if (m != NO_MOVE) {
+                position.makeMove(m);
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return true;
+}
+
+static bool writeAll(FILE* file, const void* data, size_t size, size_t count) {
+    return count == 0 || std::fwrite(data, size, count, file) == count;
+}
+
+static bool writePadding(FILE* file, size_t bytes) {
+    static const char zeros[8] = {};
+    return writeAll(file, zeros, 1, padTo8(bytes) - bytes);
+}
+
+bool buildPositionIndex(const GameArchive& archive, const char* path, int threads, int maxPly) {
+    uint64_t games = archive.size();
+    if (games > UINT32_MAX) {
+        return false;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (uint64_t(threads) > games) {
+        threads = games > 0 ? int(games) : 1;
+    }
+
+    // Each thread replays and sorts its own share of the games
+    std::vector<std::vector<Occurrence>> parts(threads);
+    std::vector<char> ok(threads, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            ok[t] = collect(archive, games * t / threads, games * (t + 1) / threads, maxPly, parts[t]) ? 1 : 0;
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (std::find(ok.begin(), ok.end(), 0) != ok.end()) {
+        return false;
+    }
+
+    // Merge the sorted parts, folding each run of one key into a position
+    // record, its continuations and its game list
+    std::vector<IndexPosition> positions;
+    std::vector<IndexContinuation> continuations;
+    std::vector<uint32_t> gameRefs;
+
+    typedef std::pair<const Occurrence*, const Occurrence*> Cursor;
+    auto later = [](const Cursor& a, const Cursor& b) {
+        return *b.first < *a.first;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heap(later);
+    for (const std::vector<Occurrence>& part : parts) {
+        if (!part.empty()) {
+            heap.push(Cursor(part.data(), part.data() + part.size()));
+        }
+    }
+
+    std::vector<IndexContinuation> moves;
+    Occurrence previous = { 0, UINT32_MAX, NO_MOVE, RESULT_UNKNOWN };
+    bool open = false;
+    auto finishPosition = [&]() {
+        std::sort(moves.begin(), moves.end(), [](const IndexContinuation& a, const IndexContinuation& b) {
+            return a.move < b.move;
+        });
+        continuations.insert(continuations.end(), moves.begin(), moves.end());
+        moves.clear();
+    };
+
+    while (!heap.empty()) {
+        Cursor cursor = heap.top();
+        heap.pop();
+        const Occurrence o = *cursor.first;
+        if (++cursor.first != cursor.second) {
+            heap.push(cursor);
+        }
+
+        if (!open || o.key != previous.key) {
+            if (open) {
+                finishPosition();
+            }
+            positions.push_back({ o.key, uint32_t(continuations.size()), uint32_t(gameRefs.size()) });
+            open = true;
+            previous.game = UINT32_MAX;
+        }
+        bool newGame = o.game != previous.game;
+        if (newGame) {
+            gameRefs.push_back(o.game);
+        }
+
+        // A game that comes back to a position with the same move counts once
+        if (o.move != NO_MOVE && (newGame || o.move != previous.move)) {
+            IndexContinuation* entry = nullptr;
+            for (IndexContinuation& candidate : moves) {
+                if (candidate.move == o.move) {
+                    entry = &candidate;
+                }
+            }
+            if (!entry) {
+                moves.push_back({ o.move, 0, 0, 0, 0, 0 });
+                entry = &moves.back();
+            }
+            ++entry->games;
+            entry->whiteWins += o.result == WHITE_WINS ? 1 : 0;
+            entry->draws += o.result == DRAWN ? 1 : 0;
+            entry->blackWins += o.result == BLACK_WINS ? 1 : 0;
+        }
+        previous = o;
+    }
+    if (open) {
+        finishPosition();
+    }
+    if (continuations.size() > UINT32_MAX || gameRefs.size() > UINT32_MAX) {
+        return false;
+    }
+    positions.push_back({ ~Key(0), uint32_t(continuations.size()), uint32_t(gameRefs.size()) });
+    uint64_t positionCount = positions.size() - 1;
+
+    // The directory: for each key prefix, the first position at or after it
+    IndexFileHeader header = {};
+    std::memcpy(header.magic, IndexMagic, sizeof(header.magic));
+    header.version = IndexVersion;
+    header.positionCount = positionCount;
+    header.continuationCount = continuations.size();
+    header.gameRefCount = gameRefs.size();
+    header.bucketBits = chooseBucketBits(positionCount);
+
+    uint64_t buckets = uint64_t(1) << header.bucketBits;
+    std::vector<uint32_t> directory(buckets + 1);
+    uint64_t next = 0;
+    for (uint64_t bucket = 0; bucket <= buckets; ++bucket) {
+        while (next < positionCount && (positions[next].key >> (64 - header.bucketBits)) < bucket) {
+            ++next;
+        }
+        directory[bucket] = uint32_t(next);
+    }
+    directory[buckets] = uint32_t(positionCount);
+
+    FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = writeAll(file, &header, sizeof(header), 1)
+        && writeAll(file, directory.data(), sizeof(uint32_t), directory.size())
+        && writePadding(file, directory.size() * sizeof(uint32_t))
+        && writeAll(file, positions.data(), sizeof(IndexPosition), positions.size())
+        && writeAll(file, continuations.data(), sizeof(IndexContinuation), continuations.size())
+        && writePadding(file, continuations.size() * sizeof(IndexContinuation))
+        && writeAll(file, gameRefs.data(), sizeof(uint32_t), gameRefs.size());
+    written &= std::fclose(file) == 0;
+    return written;
+}
+
+bool PositionIndex::open(const char* path) {
+    close();
+    if (!file.open(path, RANDOM_ACCESS)) {
+        return false;
+    }
+
+    IndexFileHeader header;
+    if (file.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, IndexMagic, sizeof(header.magic)) != 0 || header.version != IndexVersion
+        || header.bucketBits < 1 || header.bucketBits > 24 || header.positionCount >= UINT32_MAX
+        || header.continuationCount > UINT32_MAX || header.gameRefCount > UINT32_MAX) {
+        close();
+        return false;
+    }
+
+    size_t directoryBytes = ((size_t(1) << header.bucketBits) + 1) * sizeof(uint32_t);
+    size_t positionsOffset = sizeof(header) + padTo8(directoryBytes);
+    size_t continuationsOffset = positionsOffset + (header.positionCount + 1) * sizeof(IndexPosition);
+    size_t gamesOffset = continuationsOffset + padTo8(header.continuationCount * sizeof(IndexContinuation));
+    if (gamesOffset + header.gameRefCount * sizeof(uint32_t) != file.size()) {
+        close();
+        return false;
+    }
+
+    // Lookups go from the directory to the records and from the records to
+    // the other sections, so each must stay within what it points into: the
+    // directory ascends to the record count, and the sentinel record ends at
+    // the continuation and game counts
+    const uint32_t* entries = reinterpret_cast<const uint32_t*>(file.data() + sizeof(header));
+    size_t buckets = size_t(1) << header.bucketBits;
+    for (size_t bucket = 0; bucket <= buckets; ++bucket) {
+        if (entries[bucket] > header.positionCount || (bucket > 0 && entries[bucket] < entries[bucket - 1])) {
+            close();
+            return false;
+        }
+    }
+    const IndexPosition* sentinel =
+        reinterpret_cast<const IndexPosition*>(file.data() + positionsOffset) + header.positionCount;
+    if (entries[buckets] != header.positionCount || sentinel->firstContinuation != header.continuationCount
+        || sentinel->firstGame != header.gameRefCount) {
+        close();
+        return false;
+    }
+
+    // Every section starts on an 8-byte boundary of a page-aligned mapping
+    positionCount = header.positionCount;
+    continuationCount = header.continuationCount;
+    gameRefCount = header.gameRefCount;
+    bucketShift = 64 - header.bucketBits;
+    directory = reinterpret_cast<const uint32_t*>(file.data() + sizeof(header));
+    records = reinterpret_cast<const IndexPosition*>(file.data() + positionsOffset);
+    continuations = reinterpret_cast<const IndexContinuation*>(file.data() + continuationsOffset);
+    gameRefs = reinterpret_cast<const uint32_t*>(file.data() + gamesOffset);
+    return true;
+}
+
+void PositionIndex::close() {
+    file.close();
+    positionCount = 0;
+    continuationCount = 0;
+    gameRefCount = 0;
+    bucketShift = 64;
+    directory = nullptr;
+    records = nullptr;
+    continuations = nullptr;
+    gameRefs = nullptr;
+}
+
+bool PositionIndex::find(Key key, IndexedPosition& out) const {
+    if (positionCount == 0) {
+        return false;
+    }
+    uint64_t bucket = key >> bucketShift;
+    const IndexPosition* first = records + directory[bucket];
+    const IndexPosition* last = records + directory[bucket + 1];
+    const IndexPosition* found = std::lower_bound(first, last, key, [](const IndexPosition& record, Key k) {
+        return record.key < k;
+    });
+    if (found == last || found->key != key) {
+        return false;
+    }
+
+    // A damaged record could name ranges beyond the sections
+    const IndexPosition& next = found[1];
+    if (found->firstContinuation > next.firstContinuation || next.firstContinuation > continuationCount
+        || found->firstGame > next.firstGame || next.firstGame > gameRefCount) {
+        return false;
+    }
+    out.continuations = continuations + found->firstContinuation;
+    out.continuationCount = found[1].firstContinuation - found->firstContinuation;
+    out.games = gameRefs + found->firstGame;
+    out.gameCount = found[1].firstGame - found->firstGame;
+    return true;
+}
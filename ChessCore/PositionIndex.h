@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+
+#include "GameArchive.h"
+#include "MappedFile.h"
+
+// On-disk index from position key to the games of an archive that reach
+// the position and to what was played from it, for opening-explorer
+// lookups. Built once from a GameArchive, it is served straight from a
+// memory mapping.
+//
+// File layout, integers in host byte order:
+//   IndexFileHeader
+//   the directory: for each value of the top bucketBits bits of a key, the
+//     first position with that prefix, plus one entry for the end
+//   the positions: IndexPosition records sorted by key, plus a sentinel
+//   the continuations: IndexContinuation records, grouped by position and
+//     sorted by move within each group
+//   the game references: archive game numbers, grouped by position and
+//     sorted within each group
+//
+// Keys are uniformly distributed, so the directory narrows a lookup to a
+// handful of cache lines before a short binary search, whatever the size
+// of the collection.
+
+struct IndexFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t positionCount;
+    uint64_t continuationCount;
+    uint64_t gameRefCount;
+    uint32_t bucketBits;
+    uint32_t reserved;
+};
+
+struct IndexPosition {
+    Key key;
+    // Where the position's continuations and game references begin; they
+    // end where the next record's begin
+    uint32_t firstContinuation;
+    uint32_t firstGame;
+};
+
+struct IndexContinuation {
+    Move move;
+    uint16_t reserved;
+    uint32_t games;
+    uint32_t whiteWins;
+    uint32_t draws;
+    uint32_t blackWins;
+};
+
+static_assert(sizeof(IndexFileHeader) == 40, "index file header layout");
+static_assert(sizeof(IndexPosition) == 16, "index position layout");
+static_assert(sizeof(IndexContinuation) == 20, "index continuation layout");
+
+// Everything the index holds about one position. The pointers stay valid
+// while the index is open.
+struct IndexedPosition {
+    const IndexContinuation* continuations;
+    uint32_t continuationCount;
+    // Archive game numbers, ascending, each game listed once
+    const uint32_t* games;
+    uint32_t gameCount;
+};
+
+// Index every position of the archive's games up to maxPly plies deep
+// (zero for no limit), replaying and sorting on the given number of
+// threads. The whole index is assembled in memory before it is written.
+// Returns false if the file cannot be written or the archive holds a
+// damaged game.
+bool buildPositionIndex(const GameArchive& archive, const char* path, int threads, int maxPly = 0);
+
+class PositionIndex {
+public:
+    // Map an index. Returns false if it cannot be opened, or if its header,
+    // size or directory do not match, as when the file is truncated.
+    bool open(const char* path);
+    void close();
+
+    uint64_t positions() const {
+        return positionCount;
+    }
+
+    // Look a position up by key. Returns false if no indexed game reaches
+    // it, or if its record points outside the file.
+    bool find(Key key, IndexedPosition& out) const;
+
+private:
+    MappedFile file;
+    uint64_t positionCount = 0;
+    uint64_t continuationCount = 0;
+    uint64_t gameRefCount = 0;
+    uint32_t bucketShift = 64;
+    const uint32_t* directory = nullptr;
+    const IndexPosition* records = nullptr;
+    const IndexContinuation* continuations = nullptr;
+    const uint32_t* gameRefs = nullptr;
+};
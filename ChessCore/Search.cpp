@@ -0,0 +1,529 @@
+#include "Search.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "Evaluate.h"
+
+// Ordering bands; history scores stay below KillerScore because they are halved before they get there
+static const int PvScore = 1 << 30;
+static const int CaptureScore = 1 << 28;
+static const int KillerScore = 1 << 26;
+static const int HistoryLimit = 1 << 24;
+
+// Mate scores are stored relative to the node rather than the root, so an
+// entry stays right when the same position turns up at another ply
+static int scoreToTT(int score, int ply) {
+    return score >= MATE_BOUND ? score + ply : score <= -MATE_BOUND ? score - ply : score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    return score >= MATE_BOUND ? score - ply : score <= -MATE_BOUND ? score + ply : score;
+}
+
+// A table result as a score at the given ply. Mates too far off for the
+// mate range still outrank any evaluation, the nearer the higher.
+static int tablebaseScore(const TbResult& result, int ply) {
+    if (result.outcome == TB_DRAW) {
+        return 0;
+    }
+    int distance = ply + result.plies;
+    int score = distance < MAX_PLY ? MATE_SCORE - distance : MATE_BOUND - 1 - (distance - MAX_PLY);
+    return result.outcome == TB_WIN ? score : -score;
+}
+
+Searcher::Searcher(TranspositionTable& tt)
+    : tt(tt), stopSignal(nullptr), threadIndex(0), publishedNodes(0), tablebases(nullptr), tbHits(0) {
+    std::memset(killers, 0, sizeof(killers));
+    std::memset(history, 0, sizeof(history));
+    previousPvLength = 0;
+}
+
+SearchResult Searcher::search(const Position& root, const SearchLimits& limits) {
+    std::atomic<bool> stop(false);
+    tt.newSearch();
+    return iterate(root, limits, 0, stop);
+}
+
+SearchResult Searcher::iterate(const Position& root, const SearchLimits& limits, int thread, std::atomic<bool>& stop) {
+    auto start = std::chrono::steady_clock::now();
+    position = root;
+    nodes = 0;
+    publishedNodes.store(0, std::memory_order_relaxed);
+    ttProbes = 0;
+    ttHits = 0;
+    tablebases = limits.tablebases;
+    tbHits = 0;
+    stopped = false;
+    stopSignal = &stop;
+    threadIndex = thread;
+    hasDeadline = limits.moveTimeMs > 0;
+    deadline = start + std::chrono::milliseconds(limits.moveTimeMs);
+
+    // Killers belong to the previous search's plies; history is only aged
+    std::memset(killers, 0, sizeof(killers));
+    for (auto& side : history) {
+        for (auto& from : side) {
+            for (int& score : from) {
+                score /= 2;
+            }
+        }
+    }
+    previousPvLength = 0;
+
+    SearchResult result;
+    MoveList rootMoves;
+    generateMoves(position, rootMoves);
+    if (rootMoves.size() == 0) {
+        result.score = position.inCheck() ? -MATE_SCORE : 0;
+        return result;
+    }
+    result.bestMove = rootMoves.moves[0];
+
+    // A root the tables cover is answered by them: the quickest win, the
+    // slowest loss or a move that holds the draw. A reply they cannot
+    // score, such as one leaving an en-passant capture open, means searching.
+    TbResult rootValue;
+    if (tablebases && tablebases->probe(position, rootValue)) {
+        int bestScore = -INFINITE_SCORE;
+        bool covered = true;
+        for (int i = 0; i < rootMoves.size() && covered; ++i) {
+            TbResult reply;
+            position.makeMove(rootMoves.moves[i]);
+            covered = tablebases->probe(position, reply);
+            position.unmakeMove();
+            int score = -tablebaseScore(reply, 1);
+            if (covered && score > bestScore) {
+                bestScore = score;
+                result.bestMove = rootMoves.moves[i];
+            }
+        }
+        if (covered) {
+            result.score = bestScore;
+            result.depth = 1;
+            result.pv.assign(1, result.bestMove);
+            result.nodes = uint64_t(rootMoves.size());
+            result.tbHits = uint64_t(rootMoves.size()) + 1;
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (limits.onIteration) {
+                limits.onIteration(result);
+            }
+            return result;
+        }
+    }
+
+    int maxDepth = std::min(limits.depth, MAX_PLY - 1);
+    for (int depth = 1 + (thread & 1); depth <= maxDepth && !stop.load(std::memory_order_relaxed); ++depth) {
+        followPv = true;
+        int score = pvSearch(-INFINITE_SCORE, INFINITE_SCORE, depth, 0, false);
+        if (stopped) {
+            break;
+        }
+
+        result.depth = depth;
+        result.score = score;
+        result.pv.assign(pvTable[0], pvTable[0] + pvLength[0]);
+        result.bestMove = result.pv.empty() ? result.bestMove : result.pv[0];
+        std::copy(pvTable[0], pvTable[0] + pvLength[0], previousPv);
+        previousPvLength = pvLength[0];
+
+        if (limits.onIteration) {
+            result.nodes = nodes;
+            result.ttProbes = ttProbes;
+            result.ttHits = ttHits;
+            result.tbHits = tbHits;
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            limits.onIteration(result);
+        }
+
+        if (thread > 0) {
+            continue;
+        }
+        // A forced move needs no more thought, nor does a mate already found within the horizon
+        if (rootMoves.size() == 1 && hasDeadline) {
+            break;
+        }
+        if (std::abs(score) >= MATE_BOUND && MATE_SCORE - std::abs(score) <= depth) {
+            break;
+        }
+        // The next iteration takes several times longer than this one, so don't start what can't finish
+        if (hasDeadline && std::chrono::steady_clock::now() - start > (deadline - start) / 2) {
+            break;
+        }
+    }
+
+    result.nodes = nodes;
+    result.ttProbes = ttProbes;
+    result.ttHits = ttHits;
+    result.tbHits = tbHits;
+    result.hashfull = tt.hashfull();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void Searcher::checkTime() {
+    publishedNodes.store(nodes, std::memory_order_relaxed);
+    if (stopSignal->load(std::memory_order_relaxed)) {
+        stopped = true;
+    }
+    // The main thread's first iteration always completes so there is a move to return
+    else if (threadIndex == 0 && hasDeadline && previousPvLength > 0 && std::chrono::steady_clock::now() >= deadline) {
+        stopped = true;
+        stopSignal->store(true, std::memory_order_relaxed);
+    }
+}
+
+int Searcher::pvSearch(int alpha, int beta, int depth, int ply, bool allowNull) {
+    pvLength[ply] = ply;
+
+    bool inCheck = position.inCheck();
+    if (inCheck) {
+        ++depth;
+    }
+    if (depth <= 0) {
+        return quiescence(alpha, beta, ply);
+    }
+
+    if ((++nodes & 2047) == 0) {
+        checkTime();
+    }
+    if (stopped) {
+        return 0;
+    }
+
+    if (ply > 0) {
+        // Drawn by rule: a fifty-move draw unless the last move mated. A
+        // single repetition is scored as a draw, since whatever the side to
+        // move could do better here it could have done the first time.
+        if (position.isRepetition() || position.hasInsufficientMaterial()
+            || (position.halfmoveClock() >= 100 && !(inCheck && !hasLegalMove(position)))) {
+            return 0;
+        }
+        if (ply >= MAX_PLY - 1) {
+            return evaluate(position);
+        }
+
+        // No line from here can beat a mate already found closer to the root
+        alpha = std::max(alpha, -MATE_SCORE + ply);
+        beta = std::min(beta, MATE_SCORE - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+
+        // The tables know the exact result, so there is nothing to search
+        TbResult tbResult;
+        if (tablebases && popCount(position.occupied()) <= tablebases->maxPieces()
+            && tablebases->probe(position, tbResult)) {
+            ++tbHits;
+            return tablebaseScore(tbResult, ply);
+        }
+    }
+
+    bool pvNode = beta - alpha > 1;
+    Color us = position.sideToMove();
+    int originalAlpha = alpha;
+
+    // A deep enough stored result settles the node outright, except on the
+    // principal variation where the full line is wanted
+    TTEntry ttEntry;
+    Move ttMove = NO_MOVE;
+    ++ttProbes;
+    if (tt.probe(position.key(), ttEntry)) {
+        ++ttHits;
+        ttMove = ttEntry.move;
+        int ttScore = scoreFromTT(ttEntry.score, ply);
+        if (!pvNode && ply > 0 && ttEntry.depth >= depth
+            && (ttEntry.bound == BOUND_EXACT || (ttEntry.bound == BOUND_LOWER && ttScore >= beta)
+                || (ttEntry.bound == BOUND_UPPER && ttScore <= alpha))) {
+            return ttScore;
+        }
+    }
+
+    // If passing the turn still fails high, a real move almost certainly
+    // would too. Zugzwang makes that false, so pawn-only endings are excluded.
+    Bitboard nonPawn = position.pieces(us) & ~position.pieces(us, PAWN) & ~position.pieces(us, KING);
+    if (allowNull && !pvNode && !inCheck && depth >= 3 && nonPawn && evaluate(position) >= beta) {
+        int reduction = 2 + depth / 6;
+        position.makeNullMove();
+        int score = -pvSearch(-beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+        position.unmakeNullMove();
+        if (stopped) {
+            return 0;
+        }
+        if (score >= beta) {
+            return score >= MATE_BOUND ? beta : score;
+        }
+    }
+
+    MoveList moves;
+    generateMoves(position, moves);
+    if (moves.size() == 0) {
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    int scores[MAX_MOVES];
+    scoreMoves(moves, scores, ply, ttMove);
+
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove = NO_MOVE;
+    for (int i = 0; i < moves.size(); ++i) {
+        // Selection sort one step at a time, since a cutoff often comes early
+        int best = i;
+        for (int j = i + 1; j < moves.size(); ++j) {
+            if (scores[j] > scores[best]) {
+                best = j;
+            }
+        }
+        std::swap(moves.moves[i], moves.moves[best]);
+        std::swap(scores[i], scores[best]);
+        Move m = moves.moves[i];
+        bool quiet = !isCapture(m) && !isPromotion(m);
+
+        position.makeMove(m);
+        int score;
+        if (i == 0) {
+            score = -pvSearch(-beta, -alpha, depth - 1, ply + 1, true);
+        }
+        else {
+            // Late quiet moves are searched shallower first and only get a
+            // full-depth search if they unexpectedly beat alpha
+            int reduction = 0;
+            if (depth >= 3 && i >= 3 && quiet && !inCheck && scores[i] < KillerScore && !position.inCheck()) {
+                reduction = (i >= 8 && depth >= 6) ? 2 : 1;
+            }
+            score = -pvSearch(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1, true);
+            if (score > alpha && reduction > 0) {
+                score = -pvSearch(-alpha - 1, -alpha, depth - 1, ply + 1, true);
+            }
+            if (score > alpha && score < beta) {
+                score = -pvSearch(-beta, -alpha, depth - 1, ply + 1, true);
+            }
+        }
+        position.unmakeMove();
+
+        if (stopped) {
+            return 0;
+        }
+        if (score <= bestScore) {
+            continue;
+        }
+        bestScore = score;
+        if (score <= alpha) {
+            continue;
+        }
+
+        alpha = score;
+        bestMove = m;
+        pvTable[ply][ply] = m;
+        for (int next = ply + 1; next < pvLength[ply + 1]; ++next) {
+            pvTable[ply][next] = pvTable[ply + 1][next];
+        }
+        pvLength[ply] = pvLength[ply + 1];
+
+        if (score >= beta) {
+            if (quiet) {
+                if (killers[ply][0] != m) {
+                    killers[ply][1] = killers[ply][0];
+                    killers[ply][0] = m;
+                }
+                int& h = history[us][moveFrom(m)][moveTo(m)];
+                h += depth * depth;
+                if (h > HistoryLimit) {
+                    for (auto& from : history[us]) {
+                        for (int& value : from) {
+                            value /= 2;
+                        }
+                    }
+                }
+            }
+            break;
+        }
+    }
+
+    Bound bound = bestScore >= beta ? BOUND_LOWER : bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+    tt.store(position.key(), bestMove, scoreToTT(bestScore, ply), depth, bound);
+    return bestScore;
+}
+
+// Resolve captures until the position is quiet so that the static
+// evaluation is never taken in the middle of an exchange
+int Searcher::quiescence(int alpha, int beta, int ply) {
+    if ((++nodes & 2047) == 0) {
+        checkTime();
+    }
+    if (stopped) {
+        return 0;
+    }
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(position);
+    }
+
+    // In check every evasion is searched and standing pat is not an option
+    bool inCheck = position.inCheck();
+    MoveList moves;
+    int bestScore;
+    if (inCheck) {
+        generateMoves(position, moves);
+        if (moves.size() == 0) {
+            return -MATE_SCORE + ply;
+        }
+        bestScore = -INFINITE_SCORE;
+    }
+    else {
+        bestScore = evaluate(position);
+        if (bestScore >= beta) {
+            return bestScore;
+        }
+        alpha = std::max(alpha, bestScore);
+        generateCaptures(position, moves);
+    }
+
+    int scores[MAX_MOVES];
+    scoreMoves(moves, scores, ply, NO_MOVE);
+
+    for (int i = 0; i < moves.size(); ++i) {
+        int best = i;
+        for (int j = i + 1; j < moves.size(); ++j) {
+            if (scores[j] > scores[best]) {
+                best = j;
+            }
+        }
+        std::swap(moves.moves[i], moves.moves[best]);
+        std::swap(scores[i], scores[best]);
+        Move m = moves.moves[i];
+
+        // Underpromotions only matter in rare quiet positions, never in an exchange
+        if (!inCheck && isPromotion(m) && promotionType(m) != QUEEN) {
+            continue;
+        }
+
+        position.makeMove(m);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        position.unmakeMove();
+
+        if (stopped) {
+            return 0;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (score >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+    return bestScore;
+}
+
+void Searcher::scoreMoves(const MoveList& moves, int* scores, int ply, Move ttMove) {
+    bool pvHere = followPv && ply < previousPvLength;
+    followPv = false;
+    Color us = position.sideToMove();
+
+    for (int i = 0; i < moves.size(); ++i) {
+        Move m = moves.moves[i];
+        if (pvHere && m == previousPv[ply]) {
+            scores[i] = PvScore;
+            followPv = true;
+        }
+        else if (m == ttMove) {
+            scores[i] = PvScore - 1;
+        }
+        else if (isCapture(m) || isPromotion(m)) {
+            // Most valuable victim first, cheapest attacker breaking ties
+            Piece victim = moveFlag(m) == EN_PASSANT ? makePiece(~us, PAWN) : position.pieceOn(moveTo(m));
+            int gain = victim == NO_PIECE ? 0 : PieceValues[typeOf(victim)];
+            if (isPromotion(m)) {
+                gain += PieceValues[promotionType(m)];
+            }
+            scores[i] = CaptureScore + gain * 8 - typeOf(position.pieceOn(moveFrom(m)));
+        }
+        else if (m == killers[ply][0]) {
+            scores[i] = KillerScore + 1;
+        }
+        else if (m == killers[ply][1]) {
+            scores[i] = KillerScore;
+        }
+        else {
+            scores[i] = history[us][moveFrom(m)][moveTo(m)];
+        }
+    }
+}
+
+SearchPool::SearchPool(TranspositionTable& tt, int threads)
+    : tt(tt) {
+    setThreads(threads);
+}
+
+void SearchPool::setThreads(int threads) {
+    workers.resize(threads < 1 ? 1 : threads);
+    for (auto& worker : workers) {
+        if (!worker) {
+            worker = std::make_unique<Searcher>(tt);
+        }
+    }
+}
+
+SearchResult SearchPool::search(const Position& root, const SearchLimits& limits) {
+    std::atomic<bool> stop(false);
+    return search(root, limits, stop);
+}
+
+SearchResult SearchPool::search(const Position& root, const SearchLimits& limits, std::atomic<bool>& stop) {
+    tt.newSearch();
+
+    // Only the main thread reports iterations, with the helpers' work added in
+    SearchLimits mainLimits = limits;
+    SearchLimits helperLimits = limits;
+    helperLimits.onIteration = nullptr;
+    if (limits.onIteration) {
+        mainLimits.onIteration = [&](const SearchResult& iteration) {
+            SearchResult total = iteration;
+            for (size_t i = 1; i < workers.size(); ++i) {
+                total.nodes += workers[i]->nodeCount();
+            }
+            total.hashfull = tt.hashfull();
+            limits.onIteration(total);
+        };
+    }
+
+    // Counts from the last search must not leak into this one's first report
+    for (auto& worker : workers) {
+        worker->publishedNodes.store(0, std::memory_order_relaxed);
+    }
+
+    std::vector<SearchResult> results(workers.size());
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        helpers.emplace_back([&, i] {
+            results[i] = workers[i]->iterate(root, helperLimits, int(i), stop);
+        });
+    }
+    results[0] = workers[0]->iterate(root, mainLimits, 0, stop);
+
+    // Helpers search until the main thread is done with the move
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    SearchResult best = results[0];
+    for (size_t i = 1; i < results.size(); ++i) {
+        if (results[i].depth > best.depth && results[i].bestMove != NO_MOVE) {
+            best.bestMove = results[i].bestMove;
+            best.score = results[i].score;
+            best.depth = results[i].depth;
+            best.pv = results[i].pv;
+        }
+        best.nodes += results[i].nodes;
+        best.ttProbes += results[i].ttProbes;
+        best.ttHits += results[i].ttHits;
+        best.tbHits += results[i].tbHits;
+    }
+    best.hashfull = tt.hashfull();
+    return best;
+}
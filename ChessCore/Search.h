@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "MoveGen.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+const int MAX_PLY = 128;
+const int INFINITE_SCORE = 32001;
+const int MATE_SCORE = 32000;
+
+// Scores beyond this bound are forced mates, MATE_SCORE minus the number of
+// plies from the root
+const int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+struct SearchResult;
+
+struct SearchLimits {
+    int depth = MAX_PLY - 1;
+    // Thinking time in milliseconds; zero leaves the search bounded by depth only
+    int moveTimeMs = 0;
+    // Called from the searching thread after every completed iteration
+    std::function<void(const SearchResult&)> onIteration;
+    // Let an Engine answer from its opening book when it has one
+    bool useBook = true;
+    // Endgame tables to probe once few enough pieces are left
+    const Tablebases* tablebases = nullptr;
+};
+
+struct SearchResult {
+    Move bestMove = NO_MOVE;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+    std::vector<Move> pv;
+
+    // Transposition table lookups made and found, and its fill in permille
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    int hashfull = 0;
+
+    // Positions settled by the endgame tables
+    uint64_t tbHits = 0;
+};
+
+// Iterative-deepening principal variation search with a quiescence search
+// at the leaves. Moves are tried in the order: previous principal variation,
+// captures by most valuable victim and least valuable attacker, killer
+// moves, then quiet moves by history score. Null-move pruning and late-move
+// reductions cut the tree further, and results are kept in a transposition
+// table that outlives the search and may be shared with other searchers.
+// With endgame tables, positions they cover are scored from them, and a
+// root they cover is answered by them outright.
+//
+// A Searcher holds around 100 KB of tables, so keep one around rather than
+// building it on the stack for every move. It is cache-line aligned so that
+// searchers working side by side in a SearchPool never share a line.
+class alignas(64) Searcher {
+public:
+    explicit Searcher(TranspositionTable& tt);
+
+    // Search the position until the depth or time limit is reached. Only
+    // fully completed iterations are reported, except that a position with
+    // legal moves always yields one even when the budget runs out first.
+    SearchResult search(const Position& root, const SearchLimits& limits);
+
+private:
+    friend class SearchPool;
+
+    // Node count as last published for other threads to read
+    uint64_t nodeCount() const {
+        return publishedNodes.load(std::memory_order_relaxed);
+    }
+
+    // One thread's part of a search. Thread 0 owns the clock and the
+    // stopping decisions and raises the stop flag when its time is up;
+    // helpers start one ply deeper on odd indices and run until stopped.
+    SearchResult iterate(const Position& root, const SearchLimits& limits, int thread, std::atomic<bool>& stop);
+
+    int pvSearch(int alpha, int beta, int depth, int ply, bool allowNull);
+    int quiescence(int alpha, int beta, int ply);
+    void scoreMoves(const MoveList& moves, int* scores, int ply, Move ttMove);
+    void checkTime();
+
+    TranspositionTable& tt;
+    std::atomic<bool>* stopSignal;
+    int threadIndex;
+    Position position;
+    uint64_t nodes;
+    std::atomic<uint64_t> publishedNodes;
+    uint64_t ttProbes;
+    uint64_t ttHits;
+    const Tablebases* tablebases;
+    uint64_t tbHits;
+    bool stopped;
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point deadline;
+
+    Move killers[MAX_PLY][2];
+    int history[COLOR_NB][SQUARE_NB][SQUARE_NB];
+
+    // Triangular principal variation table, plus the line from the last
+    // completed iteration that the next one searches first
+    Move pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    Move previousPv[MAX_PLY];
+    int previousPvLength;
+    bool followPv;
+};
+
+// Lazy SMP: every thread runs its own Searcher over the same root position,
+// sharing nothing but the transposition table. What one thread stores
+// steers and cuts the others, so the threads together reach a given depth
+// sooner than one alone. Each worker keeps its own position, history,
+// killers and PV tables.
+class SearchPool {
+public:
+    SearchPool(TranspositionTable& tt, int threads = 1);
+
+    void setThreads(int threads);
+
+    int threads() const {
+        return int(workers.size());
+    }
+
+    // Search on all threads and report the deepest completed iteration of
+    // any of them, with node and table counts summed over every thread
+    SearchResult search(const Position& root, const SearchLimits& limits);
+
+    // As above, also stopping early once another thread raises the flag
+    SearchResult search(const Position& root, const SearchLimits& limits, std::atomic<bool>& stop);
+
+private:
+    TranspositionTable& tt;
+    std::vector<std::unique_ptr<Searcher>> workers;
+};
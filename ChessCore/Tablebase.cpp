@@ -0,0 +1,850 @@
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include "MoveGen.h"
+
+static const char TablebaseMagic[4] = { 'C', 'T', 'B', 'L' };
+static const uint32_t TablebaseVersion = 1;
+
+// Entry codes; see the file layout in Tablebase.h
+static const uint8_t CodeDraw = 0;
+static const uint8_t CodeInvalid = 1;
+static const int MaxPlies = 255 - 2;
+
+static const char PieceLetters[PIECE_TYPE_NB + 1] = "PNBRQK";
+static const int PieceValues[PIECE_TYPE_NB] = { 1, 3, 3, 5, 9, 0 };
+
+// The white king's squares in a pawnless table: the triangle a1-d1-d4
+struct KingTriangle {
+    int8_t index[SQUARE_NB];
+    Square square[10];
+};
+
+constexpr KingTriangle makeKingTriangle() {
+    KingTriangle triangle{};
+    int next = 0;
+    for (int s = 0; s < SQUARE_NB; ++s) {
+        bool inside = (s & 7) <= 3 && (s >> 3) <= (s & 7);
+        triangle.index[s] = int8_t(inside ? next : -1);
+        if (inside) {
+            triangle.square[next++] = Square(s);
+        }
+    }
+    return triangle;
+}
+
+static constexpr KingTriangle Triangle = makeKingTriangle();
+
+struct Tablebases::Table {
+    std::string material;
+    int pieceCount = 0;
+    // White king, black king, then the other white and black pieces as
+    // they are written in the signature
+    Piece pieces[TB_MAX_PIECES];
+    bool pawns = false;
+    uint64_t entries = 0;
+    // Piece counts in four bits per piece, as they are and colour-swapped
+    uint64_t materialKey = 0;
+    uint64_t mirroredKey = 0;
+    int maxPlies = 0;
+
+    // A table being generated is read from a byte per entry, a loaded one
+    // from its packed file
+    const uint8_t* codes = nullptr;
+    MappedFile file;
+    const uint64_t* packed = nullptr;
+    uint32_t bits = 0;
+
+    int kingSquares() const {
+        return pawns ? 32 : 10;
+    }
+
+    uint8_t code(uint64_t index) const {
+        if (codes) {
+            return codes[index];
+        }
+        uint64_t bit = index * bits;
+        const uint64_t* word = packed + (bit >> 6);
+        unsigned shift = unsigned(bit & 63);
+        uint64_t value = word[0] >> shift;
+        if (shift + bits > 64) {
+            value |= word[1] << (64 - shift);
+        }
+        return uint8_t(value & ((uint64_t(1) << bits) - 1));
+    }
+};
+
+static uint64_t materialKey(const Position& position) {
+    uint64_t key = 0;
+    for (int piece = 0; piece < PIECE_NB; ++piece) {
+        key += uint64_t(popCount(position.pieces(Piece(piece)))) << (4 * piece);
+    }
+    return key;
+}
+
+static int pieceLetterType(char letter) {
+    const char* found = std::strchr(PieceLetters, letter);
+    return letter != '\0' && found ? int(found - PieceLetters) : -1;
+}
+
+// One side of a signature, its king first and the rest strongest first.
+// Returns an empty string unless it holds exactly one king.
+static std::string sortSide(const std::string& side) {
+    int counts[PIECE_TYPE_NB] = {};
+    for (char letter : side) {
+        int type = pieceLetterType(letter);
+        if (type < 0) {
+            return "";
+        }
+        ++counts[type];
+    }
+    if (counts[KING] != 1) {
+        return "";
+    }
+    std::string sorted = "K";
+    for (int type = QUEEN; type >= PAWN; --type) {
+        sorted.append(counts[type], PieceLetters[type]);
+    }
+    return sorted;
+}
+
+// Whether one sorted side outweighs the other: by material, then by piece
+// count, then by the first piece that differs
+static bool stronger(const std::string& a, const std::string& b) {
+    int valueA = 0, valueB = 0;
+    for (char letter : a) {
+        valueA += PieceValues[pieceLetterType(letter)];
+    }
+    for (char letter : b) {
+        valueB += PieceValues[pieceLetterType(letter)];
+    }
+    if (valueA != valueB) {
+        return valueA > valueB;
+    }
+    if (a.size() != b.size()) {
+        return a.size() > b.size();
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] != b[i]) {
+            return pieceLetterType(a[i]) > pieceLetterType(b[i]);
+        }
+    }
+    return false;
+}
+
+std::string materialOf(const Position& position) {
+    std::string material;
+    for (Color c : { WHITE, BLACK }) {
+        material += c == WHITE ? "K" : "vK";
+        for (int type = QUEEN; type >= PAWN; --type) {
+            material.append(popCount(position.pieces(c, PieceType(type))), PieceLetters[type]);
+        }
+    }
+    return material;
+}
+
+std::string canonicalMaterial(const std::string& material) {
+    size_t split = material.find('v');
+    if (split == std::string::npos) {
+        return "";
+    }
+    std::string white = sortSide(material.substr(0, split));
+    std::string black = sortSide(material.substr(split + 1));
+    if (white.empty() || black.empty() || white.size() + black.size() > size_t(TB_MAX_PIECES)) {
+        return "";
+    }
+    return stronger(black, white) ? black + "v" + white : white + "v" + black;
+}
+
+static Square flipFile(Square s) {
+    return Square(s ^ 7);
+}
+
+static Square flipRank(Square s) {
+    return Square(s ^ 56);
+}
+
+static Square transpose(Square s) {
+    return Square(((s & 7) << 3) | (s >> 3));
+}
+
+static void transformAll(int count, Square* squares, Square (*transform)(Square)) {
+    for (int i = 0; i < count; ++i) {
+        squares[i] = transform(squares[i]);
+    }
+}
+
+static void sortIdentical(const Tablebases::Table& table, Square* squares) {
+    for (int i = 1; i < table.pieceCount; ++i) {
+        for (int j = i; j > 1 && table.pieces[j - 1] == table.pieces[j] && squares[j - 1] > squares[j]; --j) {
+            std::swap(squares[j - 1], squares[j]);
+        }
+    }
+}
+
+// Bring a placement to the one form every equivalent placement shares:
+// the white king into its region, then, with the king on the a1-h8
+// diagonal where transposing the board leaves it in place, whichever of
+// the two boards sorts first
+static void canonicalize(const Tablebases::Table& table, Square* squares) {
+    int count = table.pieceCount;
+    if (fileOf(squares[0]) > 3) {
+        transformAll(count, squares, flipFile);
+    }
+    if (!table.pawns) {
+        if (rankOf(squares[0]) > 3) {
+            transformAll(count, squares, flipRank);
+        }
+        if (rankOf(squares[0]) > fileOf(squares[0])) {
+            transformAll(count, squares, transpose);
+        }
+    }
+    sortIdentical(table, squares);
+    if (!table.pawns && rankOf(squares[0]) == fileOf(squares[0])) {
+        Square other[TB_MAX_PIECES];
+        std::copy(squares, squares + count, other);
+        transformAll(count, other, transpose);
+        sortIdentical(table, other);
+        if (std::lexicographical_compare(other + 1, other + count, squares + 1, squares + count)) {
+            std::copy(other, other + count, squares);
+        }
+    }
+}
+
+// Entry of a canonical placement
+static uint64_t entryIndex(const Tablebases::Table& table, Color sideToMove, const Square* squares) {
+    int king = table.pawns ? rankOf(squares[0]) * 4 + fileOf(squares[0]) : Triangle.index[squares[0]];
+    uint64_t index = uint64_t(sideToMove) * table.kingSquares() + king;
+    for (int i = 1; i < table.pieceCount; ++i) {
+        index = index * SQUARE_NB + squares[i];
+    }
+    return index;
+}
+
+static void decodeEntry(const Tablebases::Table& table, uint64_t index, Color& sideToMove, Square* squares) {
+    for (int i = table.pieceCount - 1; i >= 1; --i) {
+        squares[i] = Square(index & 63);
+        index >>= 6;
+    }
+    int king = int(index % table.kingSquares());
+    sideToMove = Color(index / table.kingSquares());
+    squares[0] = table.pawns ? makeSquare(king & 3, king >> 2) : Triangle.square[king];
+}
+
+// Entry of a position in a table, reading the colours swapped when flipped
+static uint64_t positionEntry(const Tablebases::Table& table, const Position& position, bool flipped) {
+    Bitboard remaining[PIECE_NB];
+    for (int piece = 0; piece < PIECE_NB; ++piece) {
+        remaining[piece] = position.pieces(Piece(piece));
+    }
+    Square squares[TB_MAX_PIECES];
+    for (int i = 0; i < table.pieceCount; ++i) {
+        Piece piece = table.pieces[i];
+        if (flipped) {
+            piece = makePiece(~colorOf(piece), typeOf(piece));
+        }
+        squares[i] = popLsb(remaining[piece]);
+        if (flipped) {
+            squares[i] = flipRank(squares[i]);
+        }
+    }
+    canonicalize(table, squares);
+    return entryIndex(table, flipped ? ~position.sideToMove() : position.sideToMove(), squares);
+}
+
+// Lay a table out from its canonical signature
+static void describe(const std::string& material, Tablebases::Table& table) {
+    size_t split = material.find('v');
+    std::string sides[COLOR_NB] = { material.substr(0, split), material.substr(split + 1) };
+    table.material = material;
+    table.pieceCount = 2;
+    table.pieces[0] = W_KING;
+    table.pieces[1] = B_KING;
+    table.pawns = false;
+    for (Color c : { WHITE, BLACK }) {
+        for (size_t i = 1; i < sides[c].size(); ++i) {
+            PieceType type = PieceType(pieceLetterType(sides[c][i]));
+            table.pieces[table.pieceCount++] = makePiece(c, type);
+            table.pawns |= type == PAWN;
+        }
+    }
+    table.materialKey = table.mirroredKey = 0;
+    for (int i = 0; i < table.pieceCount; ++i) {
+        Piece piece = table.pieces[i];
+        table.materialKey += uint64_t(1) << (4 * piece);
+        table.mirroredKey += uint64_t(1) << (4 * makePiece(~colorOf(piece), typeOf(piece)));
+    }
+    table.entries = uint64_t(2) * table.kingSquares();
+    for (int i = 1; i < table.pieceCount; ++i) {
+        table.entries *= SQUARE_NB;
+    }
+}
+
+static TbResult resultOf(uint8_t code) {
+    if (code == CodeDraw) {
+        return { TB_DRAW, 0 };
+    }
+    int plies = code - 2;
+    return { plies & 1 ? TB_WIN : TB_LOSS, plies };
+}
+
+static uint32_t bitsFor(uint32_t value) {
+    uint32_t bits = 1;
+    while ((value >> bits) != 0) {
+        ++bits;
+    }
+    return bits;
+}
+
+static size_t packedWords(uint64_t entries, uint32_t bits) {
+    return size_t((entries * bits + 63) / 64) + 1;
+}
+
+// Map a table file and check it against its own signature
+static std::unique_ptr<Tablebases::Table> loadTable(const std::string& path) {
+    std::unique_ptr<Tablebases::Table> table(new Tablebases::Table);
+    TablebaseFileHeader header;
+    if (!table->file.open(path.c_str(), RANDOM_ACCESS) || table->file.size() < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, table->file.data(), sizeof(header));
+    std::string material(header.material, std::find(header.material, header.material + sizeof(header.material), '\0'));
+    if (std::memcmp(header.magic, TablebaseMagic, sizeof(header.magic)) != 0 || header.version != TablebaseVersion
+        || material.empty() || canonicalMaterial(material) != material || header.bitsPerEntry < 1
+        || header.bitsPerEntry > 8 || header.maxPlies > uint32_t(MaxPlies)) {
+        return nullptr;
+    }
+    describe(material, *table);
+    if (header.entries != table->entries
+        || table->file.size() != sizeof(header) + packedWords(header.entries, header.bitsPerEntry) * sizeof(uint64_t)) {
+        return nullptr;
+    }
+    // The words start 40 bytes into a page-aligned mapping
+    table->packed = reinterpret_cast<const uint64_t*>(table->file.data() + sizeof(header));
+    table->bits = header.bitsPerEntry;
+    table->maxPlies = int(header.maxPlies);
+    return table;
+}
+
+Tablebases::Tablebases() = default;
+
+Tablebases::~Tablebases() = default;
+
+bool Tablebases::open(const std::string& directory) {
+    close();
+    std::error_code error;
+    std::filesystem::directory_iterator entries(directory, error);
+    if (error) {
+        return false;
+    }
+    for (const std::filesystem::directory_entry& entry : entries) {
+        if (entry.path().extension() != ".ctb") {
+            continue;
+        }
+        std::unique_ptr<Table> table = loadTable(entry.path().string());
+        if (!table) {
+            close();
+            return false;
+        }
+        add(std::move(table));
+    }
+    return true;
+}
+
+void Tablebases::close() {
+    tables.clear();
+    largest = 0;
+}
+
+void Tablebases::add(std::unique_ptr<Table> table) {
+    largest = std::max(largest, table->pieceCount);
+    tables.push_back(std::move(table));
+}
+
+bool Tablebases::contains(const std::string& material) const {
+    std::string canonical = canonicalMaterial(material);
+    for (const std::unique_ptr<Table>& table : tables) {
+        if (table->material == canonical) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const Tablebases::Table* Tablebases::find(const Position& position, bool& flipped) const {
+    uint64_t key = materialKey(position);
+    for (const std::unique_ptr<Table>& table : tables) {
+        if (table->materialKey == key || table->mirroredKey == key) {
+            flipped = table->materialKey != key;
+            return table.get();
+        }
+    }
+    return nullptr;
+}
+
+bool Tablebases::probe(const Position& position, TbResult& result) const {
+    if (position.castlingRights() != NO_CASTLING || position.enPassantSquare() != NO_SQUARE
+        || popCount(position.occupied()) > largest) {
+        return false;
+    }
+    bool flipped;
+    const Table* table = find(position, flipped);
+    if (!table) {
+        return false;
+    }
+    uint8_t code = table->code(positionEntry(*table, position, flipped));
+    if (code == CodeInvalid) {
+        return false;
+    }
+    result = resultOf(code);
+    return true;
+}
+
+// Retrograde analysis of one table. Every position starts unknown except
+// the checkmates. Iteration k then settles the positions that mate or are
+// mated in exactly k plies: a win once some move reaches a loss in k - 1,
+// a loss once every move reaches a win in at most k - 1. Whatever is never
+// settled is a draw.
+//
+// Values are always checked by generating the position's moves, but only
+// positions that can have changed are looked at: those with a move into a
+// position settled in the previous iteration, found by taking moves back
+// from it, and those with a move that leaves the table, whose values come
+// from smaller tables and may be reached at any iteration.
+class TablebaseGenerator {
+public:
+    TablebaseGenerator(Tablebases& available, const std::string& material, int threads);
+
+    bool run(TablebaseStats& stats);
+
+    // Write the table and serve it from the file from now on
+    bool finish(const std::string& path);
+
+private:
+    typedef Tablebases::Table Table;
+
+    static constexpr uint8_t LeavesTable = 1;
+
+    static uint8_t marked(int iteration) {
+        return uint8_t(2 << (iteration & 1));
+    }
+
+    template <typename Work>
+    void parallel(Work work);
+
+    bool valid(uint64_t index) const;
+    void setUp(Position& position, uint64_t index) const;
+    uint8_t lookup(Position& position);
+    uint8_t evaluate(Position& position);
+    void markPredecessors(uint64_t index, uint8_t mark);
+    void settle(std::vector<std::vector<std::pair<uint64_t, uint8_t>>>& settled, int iteration);
+
+    Tablebases& available;
+    Table* table;
+    int threads;
+    std::vector<uint8_t> codes;
+    std::unique_ptr<std::atomic<uint8_t>[]> flags;
+    std::atomic<bool> overflow;
+};
+
+TablebaseGenerator::TablebaseGenerator(Tablebases& available, const std::string& material, int threads)
+    : available(available), threads(std::max(threads, 1)), overflow(false) {
+    std::unique_ptr<Table> created(new Table);
+    describe(material, *created);
+    codes.assign(created->entries, CodeDraw);
+    flags.reset(new std::atomic<uint8_t>[created->entries]());
+    created->codes = codes.data();
+    table = created.get();
+    available.add(std::move(created));
+}
+
+// Run work(thread, first, last) over the whole table, handing out blocks
+// of entries to threads as they ask for them
+template <typename Work>
+void TablebaseGenerator::parallel(Work work) {
+    const uint64_t blockSize = 4096;
+    std::atomic<uint64_t> next(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            uint64_t first;
+            while ((first = next.fetch_add(blockSize, std::memory_order_relaxed)) < table->entries) {
+                work(t, first, std::min(first + blockSize, table->entries));
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Whether an entry is the canonical slot of a legal position
+bool TablebaseGenerator::valid(uint64_t index) const {
+    Color sideToMove;
+    Square squares[TB_MAX_PIECES];
+    decodeEntry(*table, index, sideToMove, squares);
+    Bitboard occupied = 0;
+    for (int i = 0; i < table->pieceCount; ++i) {
+        if (occupied & squareBB(squares[i])) {
+            return false;
+        }
+        occupied |= squareBB(squares[i]);
+        if (typeOf(table->pieces[i]) == PAWN && (rankOf(squares[i]) == 0 || rankOf(squares[i]) == 7)) {
+            return false;
+        }
+    }
+    Square canonical[TB_MAX_PIECES];
+    std::copy(squares, squares + table->pieceCount, canonical);
+    canonicalize(*table, canonical);
+    return entryIndex(*table, sideToMove, canonical) == index;
+}
+
+void TablebaseGenerator::setUp(Position& position, uint64_t index) const {
+    Color sideToMove;
+    Square squares[TB_MAX_PIECES];
+    decodeEntry(*table, index, sideToMove, squares);
+    position.clear();
+    for (int i = 0; i < table->pieceCount; ++i) {
+        position.putPiece(table->pieces[i], squares[i]);
+    }
+    position.setSideToMove(sideToMove);
+}
+
+// Code of a position reached by a move, as far as it is known. One with
+// an en-passant capture open has no entry of its own and is worked out
+// from its moves.
+uint8_t TablebaseGenerator::lookup(Position& position) {
+    if (position.enPassantSquare() != NO_SQUARE) {
+        return evaluate(position);
+    }
+    bool flipped;
+    const Table* found = available.find(position, flipped);
+    return found ? found->code(positionEntry(*found, position, flipped)) : CodeDraw;
+}
+
+// Code of a position from the codes of the positions its moves reach
+uint8_t TablebaseGenerator::evaluate(Position& position) {
+    MoveList moves;
+    generateMoves(position, moves);
+    if (moves.size() == 0) {
+        return position.inCheck() ? 2 : CodeDraw;
+    }
+    int quickestWin = INT_MAX, slowestLoss = -1;
+    bool allLose = true;
+    for (Move m : moves) {
+        position.makeMove(m);
+        uint8_t code = lookup(position);
+        position.unmakeMove();
+        int plies = code - 2;
+        if (code < 2) {
+            allLose = false;
+        }
+        else if (plies & 1) {
+            slowestLoss = std::max(slowestLoss, plies);
+        }
+        else {
+            quickestWin = std::min(quickestWin, plies);
+            allLose = false;
+        }
+    }
+    int plies = quickestWin != INT_MAX ? quickestWin + 1 : allLose ? slowestLoss + 1 : -1;
+    if (plies > MaxPlies) {
+        overflow = true;
+        return CodeDraw;
+    }
+    return plies < 0 ? CodeDraw : uint8_t(plies + 2);
+}
+
+// Flag the positions one move before an entry, by the side not to move,
+// that stay in the table: no uncaptures and no unpromotions
+void TablebaseGenerator::markPredecessors(uint64_t index, uint8_t mark) {
+    Color sideToMove;
+    Square squares[TB_MAX_PIECES];
+    decodeEntry(*table, index, sideToMove, squares);
+    Color mover = ~sideToMove;
+    Bitboard occupied = 0;
+    for (int i = 0; i < table->pieceCount; ++i) {
+        occupied |= squareBB(squares[i]);
+    }
+
+    for (int i = 0; i < table->pieceCount; ++i) {
+        Piece piece = table->pieces[i];
+        if (colorOf(piece) != mover) {
+            continue;
+        }
+        Square s = squares[i];
+        Bitboard from = 0;
+        switch (typeOf(piece)) {
+        case KNIGHT:
+            from = knightAttacks(s);
+            break;
+        case BISHOP:
+            from = bishopAttacks(s, occupied);
+            break;
+        case ROOK:
+            from = rookAttacks(s, occupied);
+            break;
+        case QUEEN:
+            from = queenAttacks(s, occupied);
+            break;
+        case KING:
+            from = kingAttacks(s);
+            break;
+        default: {
+            // A pawn on its third rank stepped there; on its fourth it may
+            // also have come two squares
+            int back = mover == WHITE ? -8 : 8;
+            int rank = mover == WHITE ? rankOf(s) : 7 - rankOf(s);
+            Square one = Square(s + back);
+            if (rank >= 2 && !(occupied & squareBB(one))) {
+                from = squareBB(one);
+                if (rank == 3) {
+                    from |= squareBB(Square(one + back));
+                }
+            }
+            break;
+        }
+        }
+        from &= ~occupied;
+
+        while (from) {
+            Square moved[TB_MAX_PIECES];
+            std::copy(squares, squares + table->pieceCount, moved);
+            moved[i] = popLsb(from);
+            canonicalize(*table, moved);
+            flags[entryIndex(*table, mover, moved)].fetch_or(mark, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Record what the threads settled and flag the positions to look at next
+void TablebaseGenerator::settle(std::vector<std::vector<std::pair<uint64_t, uint8_t>>>& settled, int iteration) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (const std::pair<uint64_t, uint8_t>& entry : settled[t]) {
+                codes[entry.first] = entry.second;
+            }
+            for (const std::pair<uint64_t, uint8_t>& entry : settled[t]) {
+                markPredecessors(entry.first, marked(iteration + 1));
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+bool TablebaseGenerator::run(TablebaseStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Position> positions(threads);
+    std::vector<std::vector<std::pair<uint64_t, uint8_t>>> settled(threads);
+
+    // Find the legal positions and the checkmates, and which positions have
+    // a move out of the table or into an en-passant chance
+    parallel([&](int t, uint64_t first, uint64_t last) {
+        Position& position = positions[t];
+        for (uint64_t index = first; index < last; ++index) {
+            if (!valid(index)) {
+                codes[index] = CodeInvalid;
+                continue;
+            }
+            setUp(position, index);
+            if (position.isAttacked(position.kingSquare(~position.sideToMove()), position.sideToMove())) {
+                codes[index] = CodeInvalid;
+                continue;
+            }
+            MoveList moves;
+            generateMoves(position, moves);
+            if (moves.size() == 0 && position.inCheck()) {
+                settled[t].push_back({ index, 2 });
+            }
+            bool leaves = false;
+            for (Move m : moves) {
+                leaves |= isCapture(m) || isPromotion(m);
+                if (moveFlag(m) == DOUBLE_PUSH) {
+                    position.makeMove(m);
+                    leaves |= position.enPassantSquare() != NO_SQUARE;
+                    position.unmakeMove();
+                }
+            }
+            flags[index].store(leaves ? LeavesTable : 0, std::memory_order_relaxed);
+        }
+    });
+    settle(settled, 0);
+
+    int longestBelow = 0;
+    for (const std::unique_ptr<Table>& other : available.tables) {
+        longestBelow = std::max(longestBelow, other->maxPlies);
+    }
+
+    int iteration = 1;
+    for (;; ++iteration) {
+        for (std::vector<std::pair<uint64_t, uint8_t>>& part : settled) {
+            part.clear();
+        }
+        uint8_t mark = marked(iteration);
+        parallel([&](int t, uint64_t first, uint64_t last) {
+            Position& position = positions[t];
+            for (uint64_t index = first; index < last; ++index) {
+                uint8_t flag = flags[index].load(std::memory_order_relaxed);
+                if (flag & mark) {
+                    flags[index].fetch_and(uint8_t(~mark), std::memory_order_relaxed);
+                }
+                if (codes[index] != CodeDraw || !(flag & (mark | LeavesTable))) {
+                    continue;
+                }
+                setUp(position, index);
+                uint8_t code = evaluate(position);
+                if (code >= 2 && code - 2 <= iteration) {
+                    settled[t].push_back({ index, code });
+                }
+            }
+        });
+        size_t count = 0;
+        for (const std::vector<std::pair<uint64_t, uint8_t>>& part : settled) {
+            count += part.size();
+        }
+        settle(settled, iteration);
+
+        // Values from smaller tables, possibly passed on through an
+        // en-passant chance, can still settle positions after a quiet
+        // iteration, but not once they are all exhausted
+        if (overflow || (count == 0 && iteration > longestBelow + TB_MAX_PIECES)) {
+            break;
+        }
+        if (iteration >= MaxPlies) {
+            overflow = count > 0;
+            break;
+        }
+    }
+    if (overflow) {
+        return false;
+    }
+
+    stats = TablebaseStats();
+    stats.material = table->material;
+    stats.entries = table->entries;
+    stats.iterations = iteration;
+    for (uint8_t code : codes) {
+        if (code == CodeInvalid) {
+            continue;
+        }
+        ++stats.positions;
+        TbResult result = resultOf(code);
+        stats.wins += result.outcome == TB_WIN ? 1 : 0;
+        stats.draws += result.outcome == TB_DRAW ? 1 : 0;
+        stats.losses += result.outcome == TB_LOSS ? 1 : 0;
+        stats.maxPlies = std::max(stats.maxPlies, result.plies);
+    }
+    table->maxPlies = stats.maxPlies;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool TablebaseGenerator::finish(const std::string& path) {
+    TablebaseFileHeader header = {};
+    std::memcpy(header.magic, TablebaseMagic, sizeof(header.magic));
+    header.version = TablebaseVersion;
+    std::memcpy(header.material, table->material.data(), table->material.size());
+    header.entries = table->entries;
+    header.bitsPerEntry = bitsFor(uint32_t(table->maxPlies) + 2);
+    header.maxPlies = uint32_t(table->maxPlies);
+
+    std::vector<uint64_t> words(packedWords(header.entries, header.bitsPerEntry), 0);
+    for (uint64_t index = 0; index < header.entries; ++index) {
+        uint64_t bit = index * header.bitsPerEntry;
+        unsigned shift = unsigned(bit & 63);
+        words[bit >> 6] |= uint64_t(codes[index]) << shift;
+        if (shift + header.bitsPerEntry > 64) {
+            words[(bit >> 6) + 1] |= uint64_t(codes[index]) >> (64 - shift);
+        }
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(words.data(), sizeof(uint64_t), words.size(), file) == words.size();
+    written &= std::fclose(file) == 0;
+    if (!written) {
+        return false;
+    }
+
+    std::unique_ptr<Table> loaded = loadTable(path);
+    if (!loaded) {
+        return false;
+    }
+    for (std::unique_ptr<Table>& slot : available.tables) {
+        if (slot.get() == table) {
+            slot = std::move(loaded);
+            table = slot.get();
+        }
+    }
+    std::vector<uint8_t>().swap(codes);
+    return true;
+}
+
+// Signatures one capture or promotion away
+static std::vector<std::string> successors(const std::string& material) {
+    std::vector<std::string> found;
+    for (size_t i = 0; i < material.size(); ++i) {
+        char letter = material[i];
+        if (letter == 'K' || letter == 'v') {
+            continue;
+        }
+        std::string captured = canonicalMaterial(material.substr(0, i) + material.substr(i + 1));
+        found.push_back(captured);
+        if (letter == 'P') {
+            for (char promoted : { 'Q', 'R', 'B', 'N' }) {
+                found.push_back(canonicalMaterial(material.substr(0, i) + promoted + material.substr(i + 1)));
+            }
+        }
+    }
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    return found;
+}
+
+static bool generateMissing(const std::string& material, const std::string& directory, int threads,
+    Tablebases& available, const std::function<void(const TablebaseStats&)>& onTable) {
+    if (available.contains(material)) {
+        return true;
+    }
+    for (const std::string& smaller : successors(material)) {
+        if (!generateMissing(smaller, directory, threads, available, onTable)) {
+            return false;
+        }
+    }
+    TablebaseGenerator generator(available, material, threads);
+    TablebaseStats stats;
+    std::string path = (std::filesystem::path(directory) / (material + ".ctb")).string();
+    if (!generator.run(stats) || !generator.finish(path)) {
+        return false;
+    }
+    if (onTable) {
+        onTable(stats);
+    }
+    return true;
+}
+
+bool generateTablebase(const std::string& material, const std::string& directory, int threads,
+    std::function<void(const TablebaseStats&)> onTable) {
+    std::string canonical = canonicalMaterial(material);
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    Tablebases available;
+    if (canonical.empty() || !available.open(directory)) {
+        return false;
+    }
+    return generateMissing(canonical, directory, threads, available, onTable);
+}
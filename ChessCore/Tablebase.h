@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Position.h"
+
+// Endgame tablebases: for every position of one material signature, such
+// as "KQvK" or "KRPvKR", whether the side to move wins, draws or loses
+// with perfect play, and how many plies the winner needs to mate. Tables
+// are generated here by retrograde analysis and served from bit-packed
+// files mapped into memory.
+//
+// A table enumerates the side to move and the square of every piece. The
+// white king is brought into a1-d1-d4 by the board's eight symmetries, or
+// onto files a-d when pawns fix the board's orientation, and positions that
+// differ only by symmetry or by swapping identical pieces share one entry.
+// The same material with the colours swapped is read from the same table.
+//
+// File layout, integers in host byte order:
+//   TablebaseFileHeader
+//   the entries, bitsPerEntry bits each, packed into 64-bit words from the
+//     low bit up, followed by one padding word
+//
+// An entry holds 0 for a draw, 1 for a slot no legal position maps to, and
+// 2 + plies otherwise: an even number of plies to mate means the side to
+// move is getting mated, an odd number that it mates. Castling rights, en
+// passant and the fifty-move rule are left out.
+
+const int TB_MAX_PIECES = 5;
+
+struct TablebaseFileHeader {
+    char magic[4];
+    uint32_t version;
+    // Canonical signature, NUL-padded
+    char material[16];
+    uint64_t entries;
+    uint32_t bitsPerEntry;
+    // Longest distance to mate in the table, in plies
+    uint32_t maxPlies;
+};
+
+static_assert(sizeof(TablebaseFileHeader) == 40, "tablebase file header layout");
+
+enum TbOutcome {
+    TB_LOSS = -1,
+    TB_DRAW = 0,
+    TB_WIN = 1
+};
+
+// Perfect-play value for the side to move. plies counts to mate: 0 when
+// already mated, and always 0 for a draw.
+struct TbResult {
+    TbOutcome outcome;
+    int plies;
+};
+
+// What generating one table produced
+struct TablebaseStats {
+    std::string material;
+    uint64_t entries = 0;
+    uint64_t positions = 0;
+    uint64_t wins = 0;
+    uint64_t draws = 0;
+    uint64_t losses = 0;
+    int maxPlies = 0;
+    int iterations = 0;
+    double seconds = 0;
+};
+
+// Signature of the material on the board, white first, pieces strongest
+// first: "KRPvKR"
+std::string materialOf(const Position& position);
+
+// The signature tables are filed under: pieces sorted and the stronger side
+// written first. Returns an empty string if the text is not a signature of
+// two to TB_MAX_PIECES pieces.
+std::string canonicalMaterial(const std::string& material);
+
+// A set of tables loaded from one directory, safe to probe from any number
+// of threads at once
+class Tablebases {
+public:
+    Tablebases();
+    ~Tablebases();
+
+    Tablebases(const Tablebases&) = delete;
+    Tablebases& operator=(const Tablebases&) = delete;
+
+    // Load every .ctb file of the directory, replacing what was loaded
+    // before. Returns false if the directory cannot be read or holds a
+    // damaged table.
+    bool open(const std::string& directory);
+    void close();
+
+    // Most pieces of any loaded table; 0 when none is loaded
+    int maxPieces() const {
+        return largest;
+    }
+
+    bool contains(const std::string& material) const;
+
+    // Value of the position, or false when no loaded table covers it, or
+    // when it has castling rights or an en-passant square
+    bool probe(const Position& position, TbResult& result) const;
+
+    // One table's layout and storage, defined where tables are read
+    struct Table;
+
+private:
+    friend class TablebaseGenerator;
+
+    const Table* find(const Position& position, bool& flipped) const;
+    void add(std::unique_ptr<Table> table);
+
+    std::vector<std::unique_ptr<Table>> tables;
+    int largest = 0;
+};
+
+// Generate the table of a material signature into the directory, first
+// generating every smaller table it leads to by a capture or promotion
+// that the directory does not already hold. Work is spread over the given
+// number of threads. onTable is told about each table as it is written.
+// A table of n pieces needs about twice its entry count in bytes of
+// memory: 10 MB for four pieces without pawns, 670 MB for five. Returns
+// false if the signature is invalid or a file cannot be written.
+bool generateTablebase(const std::string& material, const std::string& directory, int threads,
+    std::function<void(const TablebaseStats&)> onTable = nullptr);
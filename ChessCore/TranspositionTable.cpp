@@ -0,0 +1,105 @@
+#include "TranspositionTable.h"
+
+// Data word layout: move in bits 0-15, score in 16-31, depth in 32-39,
+// bound in 40-41 and search generation in 48-55. The bound of a stored
+// entry is never BOUND_NONE, so an all-zero word marks an empty slot.
+static uint64_t pack(Move move, int score, int depth, Bound bound, uint8_t generation) {
+    return uint64_t(move) | (uint64_t(uint16_t(int16_t(score))) << 16) | (uint64_t(uint8_t(int8_t(depth))) << 32)
+        | (uint64_t(bound) << 40) | (uint64_t(generation) << 48);
+}
+
+static Move packedMove(uint64_t data) {
+    return Move(data);
+}
+
+static int packedDepth(uint64_t data) {
+    return int8_t(data >> 32);
+}
+
+static uint8_t packedGeneration(uint64_t data) {
+    return uint8_t(data >> 48);
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : bucketCount(0), generation(0) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= (megabytes << 20)) {
+        count *= 2;
+    }
+    if (count != bucketCount) {
+        buckets.reset(new Bucket[count]);
+        bucketCount = count;
+    }
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (Slot& slot : buckets[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(Key key, TTEntry& entry) const {
+    const Bucket& bucket = bucketFor(key);
+    for (const Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if (data != 0 && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+            entry.move = packedMove(data);
+            entry.score = int16_t(data >> 16);
+            entry.depth = packedDepth(data);
+            entry.bound = Bound((data >> 40) & 3);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(Key key, Move move, int score, int depth, Bound bound) {
+    Bucket& bucket = bucketFor(key);
+
+    // Overwrite this position's own entry if it is already here, otherwise
+    // the entry least worth keeping: shallow and left over from old searches
+    Slot* victim = &bucket.slots[0];
+    int victimWorth = INT32_MAX;
+    for (Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if (data == 0 || (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+            // Keep the old best move rather than forget it for a move-less bound
+            if (move == NO_MOVE && data != 0) {
+                move = packedMove(data);
+            }
+            victim = &slot;
+            break;
+        }
+        int age = uint8_t(generation - packedGeneration(data));
+        int worth = packedDepth(data) - 8 * age;
+        if (worth < victimWorth) {
+            victimWorth = worth;
+            victim = &slot;
+        }
+    }
+
+    uint64_t data = pack(move, score, depth, bound, generation);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sampled = bucketCount < 250 ? bucketCount : 250;
+    int used = 0;
+    for (size_t i = 0; i < sampled; ++i) {
+        for (const Slot& slot : buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            used += data != 0 && packedGeneration(data) == generation ? 1 : 0;
+        }
+    }
+    return sampled == 0 ? 0 : int(used * 1000 / (sampled * BucketSize));
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Move.h"
+
+enum Bound : uint8_t {
+    BOUND_NONE,
+    BOUND_UPPER,
+    BOUND_LOWER,
+    BOUND_EXACT
+};
+
+// What a probe hands back, unpacked from the stored word
+struct TTEntry {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Hash table of search results shared by any number of search threads
+// without a lock. Each entry is two 64-bit words, the packed data and the
+// position key XORed with that data, written and read with relaxed atomics.
+// A reader that catches an entry halfway through being rewritten by another
+// thread sees a key that no longer matches and treats it as a miss, so a torn
+// entry can cost a lookup but never return another position's result.
+//
+// Four entries share a 64-byte bucket aligned to a cache line, so a probe
+// touches exactly one line.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    // Reallocate to the largest power-of-two bucket count fitting in the
+    // given size, discarding everything stored
+    void resize(size_t megabytes);
+    void clear();
+
+    // Start a new search; entries from older searches become preferred victims
+    void newSearch() {
+        generation = uint8_t(generation + 1);
+    }
+
+    bool probe(Key key, TTEntry& entry) const;
+    void store(Key key, Move move, int score, int depth, Bound bound);
+
+    size_t sizeMegabytes() const {
+        return bucketCount * sizeof(Bucket) >> 20;
+    }
+
+    // Permille of entries written during the current search, estimated from
+    // the first thousand entries
+    int hashfull() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    static const int BucketSize = 4;
+
+    struct alignas(64) Bucket {
+        Slot slots[BucketSize];
+    };
+
+    Bucket& bucketFor(Key key) const {
+        return buckets[key & (bucketCount - 1)];
+    }
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount;
+    uint8_t generation;
+};
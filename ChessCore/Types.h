@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+typedef uint64_t Bitboard;
+typedef uint64_t Key;
+
+enum Color : uint8_t {
+    WHITE,
+    BLACK,
+    COLOR_NB = 2
+};
+
+enum PieceType : uint8_t {
+    PAWN,
+    KNIGHT,
+    BISHOP,
+    ROOK,
+    QUEEN,
+    KING,
+    PIECE_TYPE_NB = 6
+};
+
+// Pieces are laid out as six white types followed by six black types, so a
+// piece doubles as the index of its bitboard inside a Position.
+enum Piece : uint8_t {
+    W_PAWN, W_KNIGHT, W_BISHOP, W_ROOK, W_QUEEN, W_KING,
+    B_PAWN, B_KNIGHT, B_BISHOP, B_ROOK, B_QUEEN, B_KING,
+    NO_PIECE,
+    PIECE_NB = 12
+};
+
+// Little-endian rank-file mapping: a1 is square 0, h8 is square 63.
+enum Square : uint8_t {
+    A1, B1, C1, D1, E1, F1, G1, H1,
+    A2, B2, C2, D2, E2, F2, G2, H2,
+    A3, B3, C3, D3, E3, F3, G3, H3,
+    A4, B4, C4, D4, E4, F4, G4, H4,
+    A5, B5, C5, D5, E5, F5, G5, H5,
+    A6, B6, C6, D6, E6, F6, G6, H6,
+    A7, B7, C7, D7, E7, F7, G7, H7,
+    A8, B8, C8, D8, E8, F8, G8, H8,
+    NO_SQUARE,
+    SQUARE_NB = 64
+};
+
+enum CastlingRights : uint8_t {
+    NO_CASTLING = 0,
+    WHITE_OO = 1,
+    WHITE_OOO = 2,
+    BLACK_OO = 4,
+    BLACK_OOO = 8,
+    ALL_CASTLING = 15
+};
+
+constexpr Color operator~(Color c) {
+    return Color(c ^ 1);
+}
+
+constexpr Piece makePiece(Color c, PieceType pt) {
+    return Piece(c * 6 + pt);
+}
+
+constexpr Color colorOf(Piece p) {
+    return Color(p >= B_PAWN);
+}
+
+constexpr PieceType typeOf(Piece p) {
+    return PieceType(p % 6);
+}
+
+constexpr Square makeSquare(int file, int rank) {
+    return Square(rank * 8 + file);
+}
+
+constexpr int fileOf(Square s) {
+    return s & 7;
+}
+
+constexpr int rankOf(Square s) {
+    return s >> 3;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Types.h"
+
+// Random keys for Zobrist hashing. A position's key is the XOR of one key
+// per piece on its square, the castling-rights key, the en-passant file key
+// when a capture is possible, and the side key when black is to move. Since
+// XOR is its own inverse, a move updates the key by toggling only what changed.
+struct ZobristKeys {
+    Key pieceSquare[PIECE_NB][SQUARE_NB];
+    Key castling[16];
+    Key enPassant[8];
+    Key side;
+};
+
+// splitmix64, run by the compiler so every build hashes identically
+constexpr Key splitMix64(Key& state) {
+    Key z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    Key state = 0x2545F4914F6CDD1DULL;
+    for (auto& square : keys.pieceSquare) {
+        for (Key& k : square) {
+            k = splitMix64(state);
+        }
+    }
+    for (Key& k : keys.castling) {
+        k = splitMix64(state);
+    }
+    for (Key& k : keys.enPassant) {
+        k = splitMix64(state);
+    }
+    keys.side = splitMix64(state);
+    return keys;
+}
+
+inline constexpr ZobristKeys Zobrist = makeZobristKeys();
@@ -0,0 +1,102 @@
+#include "BoardRenderer.h"
+
+#include <algorithm>
+
+// Transparent border kept around each image in the atlas, so smoothing
+// never blends in the edge of its neighbour
+static const unsigned atlasPadding = 2;
+
+BoardRenderer::BoardRenderer(float squareSize, sf::Color lightSquare, sf::Color darkSquare)
+    : squareSize(squareSize), squares(sf::Quads, 4 * SQUARE_NB), pieces(sf::Quads) {
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            sf::Vertex* quad = &squares[4 * (row * 8 + col)];
+            float x = col * squareSize;
+            float y = row * squareSize;
+            sf::Color color = (row + col) % 2 == 1 ? darkSquare : lightSquare;
+            quad[0] = sf::Vertex(sf::Vector2f(x, y), color);
+            quad[1] = sf::Vertex(sf::Vector2f(x + squareSize, y), color);
+            quad[2] = sf::Vertex(sf::Vector2f(x + squareSize, y + squareSize), color);
+            quad[3] = sf::Vertex(sf::Vector2f(x, y + squareSize), color);
+        }
+    }
+}
+
+bool BoardRenderer::setPieceImages(const sf::Image (&images)[PIECE_NB]) {
+    // Pieces go in two rows of six, white above black, in equal cells
+    unsigned cellWidth = 0;
+    unsigned cellHeight = 0;
+    for (const sf::Image& image : images) {
+        if (image.getSize().x == 0 || image.getSize().y == 0) {
+            return false;
+        }
+        cellWidth = std::max(cellWidth, image.getSize().x + 2 * atlasPadding);
+        cellHeight = std::max(cellHeight, image.getSize().y + 2 * atlasPadding);
+    }
+
+    sf::Image packed;
+    packed.create(6 * cellWidth, 2 * cellHeight, sf::Color::Transparent);
+    for (int p = 0; p < PIECE_NB; ++p) {
+        unsigned x = (p % 6) * cellWidth + atlasPadding;
+        unsigned y = (p / 6) * cellHeight + atlasPadding;
+        packed.copy(images[p], x, y);
+        cells[p] = sf::IntRect(int(x), int(y), int(images[p].getSize().x), int(images[p].getSize().y));
+    }
+    if (!atlas.loadFromImage(packed)) {
+        return false;
+    }
+    atlas.setSmooth(true);
+    stale = true;
+    return true;
+}
+
+// Fill four vertices with the piece's image, scaled to fit the square and
+// centred in it
+void BoardRenderer::setPieceQuad(sf::Vertex* quad, Piece piece, sf::Vector2f origin) const {
+    const sf::IntRect& cell = cells[piece];
+    float scale = squareSize / std::max(cell.width, cell.height);
+    float width = cell.width * scale;
+    float height = cell.height * scale;
+    float left = origin.x + (squareSize - width) / 2;
+    float top = origin.y + (squareSize - height) / 2;
+    float u = float(cell.left);
+    float v = float(cell.top);
+    quad[0] = sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u, v));
+    quad[1] = sf::Vertex(sf::Vector2f(left + width, top), sf::Vector2f(u + cell.width, v));
+    quad[2] = sf::Vertex(sf::Vector2f(left + width, top + height), sf::Vector2f(u + cell.width, v + cell.height));
+    quad[3] = sf::Vertex(sf::Vector2f(left, top + height), sf::Vector2f(u, v + cell.height));
+}
+
+void BoardRenderer::update(const Position& position, Square lifted) {
+    if (!stale && position.key() == shownKey && lifted == shownLifted) {
+        return;
+    }
+    stale = false;
+    shownKey = position.key();
+    shownLifted = lifted;
+
+    Bitboard occupied = position.occupied();
+    if (lifted != NO_SQUARE) {
+        occupied &= ~squareBB(lifted);
+    }
+    pieces.resize(4 * popCount(occupied));
+    for (size_t i = 0; occupied; i += 4) {
+        Square s = popLsb(occupied);
+        sf::Vector2f origin(fileOf(s) * squareSize, (7 - rankOf(s)) * squareSize);
+        setPieceQuad(&pieces[i], position.pieceOn(s), origin);
+    }
+}
+
+void BoardRenderer::draw(sf::RenderTarget& target, Piece lifted, sf::Vector2f liftedAt) const {
+    target.draw(squares);
+    target.draw(pieces, sf::RenderStates(&atlas));
+    if (lifted != NO_PIECE) {
+        drawPiece(target, lifted, liftedAt);
+    }
+}
+
+void BoardRenderer::drawPiece(sf::RenderTarget& target, Piece piece, sf::Vector2f origin) const {
+    sf::Vertex quad[4];
+    setPieceQuad(quad, piece, origin);
+    target.draw(quad, 4, sf::Quads, sf::RenderStates(&atlas));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "Position.h"
+
+// Draws the board and its pieces in a handful of draw calls. The twelve
+// piece images are packed into one atlas texture, the squares are one
+// vertex array built once, and the pieces are a second one that is rebuilt
+// only when the position or the lifted piece changes. A piece being dragged
+// is left out of the array and drawn as a single quad wherever it is held.
+class BoardRenderer {
+public:
+    BoardRenderer(float squareSize, sf::Color lightSquare, sf::Color darkSquare);
+
+    // Pack the piece images, indexed by Piece, into the atlas. Returns false
+    // if an image is empty or the texture cannot be created.
+    bool setPieceImages(const sf::Image (&images)[PIECE_NB]);
+
+    // Bring the piece quads in line with the position, leaving out the piece
+    // on the lifted square. Cheap when nothing changed since the last call.
+    void update(const Position& position, Square lifted = NO_SQUARE);
+
+    // The board and the pieces, then the lifted piece with the top-left
+    // corner of its square at the given point
+    void draw(sf::RenderTarget& target, Piece lifted = NO_PIECE, sf::Vector2f liftedAt = sf::Vector2f()) const;
+
+    // One piece fitted into the square with the given top-left corner, as
+    // for the promotion choice
+    void drawPiece(sf::RenderTarget& target, Piece piece, sf::Vector2f origin) const;
+
+private:
+    void setPieceQuad(sf::Vertex* quad, Piece piece, sf::Vector2f origin) const;
+
+    float squareSize;
+    sf::VertexArray squares;
+    sf::VertexArray pieces;
+    sf::Texture atlas;
+    // Area of each piece's image within the atlas
+    sf::IntRect cells[PIECE_NB];
+
+    Key shownKey = 0;
+    Square shownLifted = NO_SQUARE;
+    bool stale = true;
+};
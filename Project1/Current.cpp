@@ -1,19 +1,38 @@
 #include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <future>
 #include <iostream>
-#include <unordered_map>
-#include <cmath>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "BoardRenderer.h"
+#include "Engine.h"
+#include "Game.h"
+#include "Notation.h"
+#include "Pgn.h"
+#include "PositionIndex.h"
+#include "Resources.h"
 
 const float squareSize = 504 / 8.0f;
-bool turn = true;
 bool isInsideBoard(int x, int y);
+Square squareAt(int x, int y);
 
 class ChessPiece {
 public:
-    ChessPiece(const sf::Texture& texture, const sf::Vector2f position, bool isWhite)
-        : sprite(texture), currentPosition(position), curr(position), isWhite(isWhite) {}
+    ChessPiece(const sf::Vector2f position, bool isWhite)
+        : currentPosition(position), curr(position), isWhite(isWhite),
+          boardSquare(squareAt(static_cast<int>(position.x / squareSize), static_cast<int>(position.y / squareSize))) {}
+
+    virtual bool isValidMove(int targetX, int targetY, const Position& position) const = 0;
+    virtual PieceType type() const = 0;
 
-    virtual bool isValidMove(int targetX, int targetY, const std::string(&boardLayout)[8][8]) const = 0;
+    Piece piece() const {
+        return makePiece(color(), type());
+    }
 
     bool getWhite()
     {
@@ -23,14 +42,9 @@ public:
         if (isWhite == turn)
         {
             curr = newPosition;
-            sprite.setPosition(newPosition);
         }
     }
 
-    virtual void draw(sf::RenderWindow& window) const {
-        window.draw(sprite);
-    }
-
     const sf::Vector2f& getPosition() const {
         return currentPosition;
     }
@@ -38,268 +52,217 @@ public:
     bool isSameColor(bool otherIsWhite) const {
         return isWhite == otherIsWhite;
     }
+
+    Color color() const {
+        return isWhite ? WHITE : BLACK;
+    }
+
+    bool isOwnPiece(const Position& position, Square s) const {
+        return (position.pieces(color()) & squareBB(s)) != 0;
+    }
+
+    bool isEnemyPiece(const Position& position, Square s) const {
+        return (position.pieces(~color()) & squareBB(s)) != 0;
+    }
+
+    // Board square the piece currently stands on, refreshed only when a move lands
+    Square square() const {
+        return boardSquare;
+    }
+    // Put the piece straight onto a square, whoever's turn it is
+    void place(const sf::Vector2f& newPosition) {
+        curr = newPosition;
+        setPos();
+    }
+
     void setPos()
     {
         currentPosition = curr;
+        boardSquare = squareAt(static_cast<int>(currentPosition.x / squareSize), static_cast<int>(currentPosition.y / squareSize));
     }
 
 public:
-    sf::Sprite sprite;
     sf::Vector2f currentPosition, curr;
     bool isWhite;
+
+private:
+    Square boardSquare;
 };
 
 
 class Pawn : public ChessPiece {
 public:
-    Pawn(const sf::Texture& texture, const sf::Vector2f& position, bool isWhite)
-        : ChessPiece(texture, position, isWhite), firstMove(true) {}
+    Pawn(const sf::Vector2f& position, bool isWhite)
+        : ChessPiece(position, isWhite) {}
 
+    PieceType type() const override {
+        return PAWN;
+    }
 
-    bool isValidMove(int targetX, int targetY, const std::string(&boardLayout)[8][8]) const override {
-        // Calculate the delta values
-        int deltaX = targetX - static_cast<int>(currentPosition.x / squareSize);
-        int deltaY = targetY - static_cast<int>(currentPosition.y / squareSize);
 
+    bool isValidMove(int targetX, int targetY, const Position& position) const override {
         // Check if the move is within board bounds
         if (!isInsideBoard(targetX, targetY)) {
             return false;
         }
 
-        // Check if the target square is occupied by a piece of the same color
-        if (!boardLayout[targetY][targetX].empty() && isSameColor(boardLayout[targetY][targetX][0] == 'w')) {
-            return false;
-        }
+        Square from = square();
+        Square target = squareAt(targetX, targetY);
+        int forward = isWhite ? 8 : -8;
 
         // Moving forward one square
-        if (deltaX == 0 && deltaY == (isWhite ? -1 : 1) && boardLayout[targetY][targetX].empty()) {
+        if (target == from + forward && position.isEmpty(target)) {
             return true;
         }
 
-        // Moving forward two squares at the start
-        if (deltaX == 0 && deltaY == (isWhite ? -2 : 2) && boardLayout[targetY][targetX].empty() && (static_cast<int>(currentPosition.y / squareSize) == 6 || static_cast<int>(currentPosition.y / squareSize) == 1)) {
-            // Check if the square in between is empty
-            int intermediateY = currentPosition.y / squareSize + (isWhite ? -1 : 1);
-            if (boardLayout[intermediateY][targetX].empty()) {
-                return true;
-            }
-        }
-
-        // Capturing diagonally
-        if (std::abs(deltaX) == 1 && deltaY == (isWhite ? -1 : 1) &&
-            !boardLayout[targetY][targetX].empty() && !isSameColor(boardLayout[targetY][targetX][0] == 'w')) {
+        // Moving forward two squares at the start, through an empty square
+        if (target == from + 2 * forward && rankOf(from) == (isWhite ? 1 : 6)
+            && position.isEmpty(target) && position.isEmpty(Square(from + forward))) {
             return true;
         }
 
-
-        return false;
-    }
-
-
-
-
-    void move(const sf::Vector2f& newPosition, bool turn) override {
-        ChessPiece::move(newPosition, turn);
-        firstMove = false;
+        // Capturing diagonally, an enemy piece or en passant a pawn that just went past
+        Bitboard targets = position.pieces(~color());
+        if (position.enPassantSquare() != NO_SQUARE) {
+            targets |= squareBB(position.enPassantSquare());
+        }
+        return (pawnAttacks(color(), from) & targets & squareBB(target)) != 0;
     }
-
-
-
-private:
-    bool firstMove;
 };
 
 
 class Knight : public ChessPiece {
 public:
-    Knight(const sf::Texture& texture, const sf::Vector2f& position, bool isWhite)
-        : ChessPiece(texture, position, isWhite) {}
+    Knight(const sf::Vector2f& position, bool isWhite)
+        : ChessPiece(position, isWhite) {}
 
-    bool isValidMove(int targetX, int targetY, const std::string(&boardLayout)[8][8]) const override {
-
-
-        int deltaX = targetX - static_cast<int>(currentPosition.x / squareSize);
-        int deltaY = targetY - static_cast<int>(currentPosition.y / squareSize);
-  
+    PieceType type() const override {
+        return KNIGHT;
+    }
 
+    bool isValidMove(int targetX, int targetY, const Position& position) const override {
         // Check if move is within board bounds
         if (!isInsideBoard(targetX, targetY)) {
             return false;
         }
 
         // Check if destination square is occupied by a piece of the same color
-        if (!boardLayout[targetY][targetX].empty() && isSameColor(boardLayout[targetY][targetX][0] == 'w')) {
+        if (isOwnPiece(position, squareAt(targetX, targetY))) {
             return false;
         }
 
-        // Check all 8 possible knight moves based on color
-        if ((isWhite && ((deltaX == 1 && deltaY == 2) || (deltaX == 2 && deltaY == 1) ||
-            (deltaX == 1 && deltaY == -2) || (deltaX == 2 && deltaY == -1) ||
-            (deltaX == -1 && deltaY == 2) || (deltaX == -2 && deltaY == 1) ||
-            (deltaX == -1 && deltaY == -2) || (deltaX == -2 && deltaY == -1))) ||
-            (!isWhite && ((deltaX == 1 && deltaY == 2) || (deltaX == 2 && deltaY == 1) ||
-                (deltaX == 1 && deltaY == -2) || (deltaX == 2 && deltaY == -1) ||
-                (deltaX == -1 && deltaY == 2) || (deltaX == -2 && deltaY == 1) ||
-                (deltaX == -1 && deltaY == -2) || (deltaX == -2 && deltaY == -1)))) {
-            return true; // Valid knight move
-        }
-
-        return false; // Invalid move
+        return (knightAttacks(square()) & squareBB(squareAt(targetX, targetY))) != 0;
     }
 
 };
 
 class Bishop : public ChessPiece {
 public:
-    Bishop(const sf::Texture& texture, const sf::Vector2f& position, bool isWhite)
-        : ChessPiece(texture, position, isWhite) {}
+    Bishop(const sf::Vector2f& position, bool isWhite)
+        : ChessPiece(position, isWhite) {}
 
-    bool isValidMove(int targetX, int targetY, const std::string(&boardLayout)[8][8]) const override {
-        int deltaX = targetX - static_cast<int>(currentPosition.x / squareSize);
-        int deltaY = targetY - static_cast<int>(currentPosition.y / squareSize);
+    PieceType type() const override {
+        return BISHOP;
+    }
 
+    bool isValidMove(int targetX, int targetY, const Position& position) const override {
         // Check if move is within board bounds
         if (!isInsideBoard(targetX, targetY)) {
             return false;
         }
 
         // Check if destination square is occupied by a piece of the same color
-        if (!boardLayout[targetY][targetX].empty() && isSameColor(boardLayout[targetY][targetX][0] == 'w')) {
+        if (isOwnPiece(position, squareAt(targetX, targetY))) {
             return false;
         }
 
-        // Check if the move is diagonal
-        if (std::abs(deltaX) == std::abs(deltaY)) {
-            // Check if the path is clear up to the destination square
-            int stepX = (deltaX > 0) ? 1 : -1;
-            int stepY = (deltaY > 0) ? 1 : -1;
-            int x = static_cast<int>(currentPosition.x / squareSize) + stepX;
-            int y = static_cast<int>(currentPosition.y / squareSize) + stepY;
-
-            while (x != targetX && y != targetY) {
-                if (!boardLayout[y][x].empty()) {
-                    return false; // Path is blocked
-                }
-                x += stepX;
-                y += stepY;
-            }
-
-            return true; // Valid bishop move
-        }
-
-        return false; // Invalid move
+        // The diagonal attack set already stops at the first blocker on each ray
+        return (bishopAttacks(square(), position.occupied()) & squareBB(squareAt(targetX, targetY))) != 0;
     }
 
 };
 
 class Rook : public ChessPiece {
 public:
-    Rook(const sf::Texture& texture, const sf::Vector2f& position, bool isWhite)
-        : ChessPiece(texture, position, isWhite) {}
+    Rook(const sf::Vector2f& position, bool isWhite)
+        : ChessPiece(position, isWhite) {}
 
-    bool isValidMove(int targetX, int targetY, const std::string(&boardLayout)[8][8]) const override {
-        int deltaX = targetX - static_cast<int>(currentPosition.x / squareSize);
-        int deltaY = targetY - static_cast<int>(currentPosition.y / squareSize);
+    PieceType type() const override {
+        return ROOK;
+    }
 
+    bool isValidMove(int targetX, int targetY, const Position& position) const override {
         // Check if move is within board bounds
         if (!isInsideBoard(targetX, targetY)) {
             return false;
         }
 
         // Check if destination square is occupied by a piece of the same color
-        if (!boardLayout[targetY][targetX].empty() && isSameColor(boardLayout[targetY][targetX][0] == 'w')) {
+        if (isOwnPiece(position, squareAt(targetX, targetY))) {
             return false;
         }
 
-        // Check if the move is vertical or horizontal
-        if ((deltaX == 0 && deltaY != 0) || (deltaX != 0 && deltaY == 0)) {
-            // Determine step direction based on move direction
-            int stepX = (deltaX > 0) ? 1 : (deltaX < 0) ? -1 : 0;
-            int stepY = (deltaY > 0) ? 1 : (deltaY < 0) ? -1 : 0;
-
-            // Check if the path is clear up to the destination square
-            int x = static_cast<int>(currentPosition.x / squareSize) + stepX;
-            int y = static_cast<int>(currentPosition.y / squareSize) + stepY;
-
-            while (x != targetX || y != targetY) {
-                if (!boardLayout[y][x].empty()) {
-                    return false; // Path is blocked
-                }
-                x += stepX;
-                y += stepY;
-            }
-
-            return true; // Valid rook move
-        }
-
-        return false; // Invalid move
+        // The rank and file attack set already stops at the first blocker on each ray
+        return (rookAttacks(square(), position.occupied()) & squareBB(squareAt(targetX, targetY))) != 0;
     }
 
 };
 
 class Queen : public ChessPiece {
 public:
-    Queen(const sf::Texture& texture, const sf::Vector2f& position, bool isWhite)
-        : ChessPiece(texture, position, isWhite) {}
-
-    bool isValidMove(int targetX, int targetY, const std::string(&boardLayout)[8][8]) const override {
-        int deltaX = targetX - static_cast<int>(currentPosition.x / squareSize);
-        int deltaY = targetY - static_cast<int>(currentPosition.y / squareSize);
-
-        if (deltaX == 0 && deltaY != 0) { // Vertical movement
-            int stepY = (deltaY > 0) ? 1 : -1;
-            for (int y = static_cast<int>(currentPosition.y / squareSize) + stepY; y != targetY; y += stepY) {
-                if (!boardLayout[y][targetX].empty()) {
-                    return false; // Obstacle in the path
-                }
-            }
-            return true; // No obstacles, valid move
+    Queen(const sf::Vector2f& position, bool isWhite)
+        : ChessPiece(position, isWhite) {}
+
+    PieceType type() const override {
+        return QUEEN;
+    }
+
+    bool isValidMove(int targetX, int targetY, const Position& position) const override {
+        // Check if move is within board bounds
+        if (!isInsideBoard(targetX, targetY)) {
+            return false;
         }
-        else if (deltaX != 0 && deltaY == 0) { // Horizontal movement
-            int stepX = (deltaX > 0) ? 1 : -1;
-            for (int x = static_cast<int>(currentPosition.x / squareSize) + stepX; x != targetX; x += stepX) {
-                if (!boardLayout[targetY][x].empty()) {
-                    return false; // Obstacle in the path
-                }
-            }
-            return true; // No obstacles, valid move
-        }
-        else if (std::abs(deltaX) == std::abs(deltaY)) { // Diagonal movement
-            int stepX = (deltaX > 0) ? 1 : -1;
-            int stepY = (deltaY > 0) ? 1 : -1;
-            for (int x = static_cast<int>(currentPosition.x / squareSize) + stepX, y = static_cast<int>(currentPosition.y / squareSize) + stepY;
-                x != targetX && y != targetY; x += stepX, y += stepY) {
-                if (!boardLayout[y][x].empty()) {
-                    return false; // Obstacle in the path
-                }
-            }
-            return true; // No obstacles, valid move
+
+        // Check if destination square is occupied by a piece of the same color
+        if (isOwnPiece(position, squareAt(targetX, targetY))) {
+            return false;
         }
 
-        return false; // Invalid move
+        return (queenAttacks(square(), position.occupied()) & squareBB(squareAt(targetX, targetY))) != 0;
     }
 
 };
 
 class King : public ChessPiece {
 public:
-    King(const sf::Texture& texture, const sf::Vector2f& position, bool isWhite)
-        : ChessPiece(texture, position, isWhite) {}
-    bool isValidMove(int targetX, int targetY, const std::string(&boardLayout)[8][8]) const override {
+    King(const sf::Vector2f& position, bool isWhite)
+        : ChessPiece(position, isWhite) {}
+
+    PieceType type() const override {
+        return KING;
+    }
+
+    bool isValidMove(int targetX, int targetY, const Position& position) const override {
         // Check if move is within board bounds
         if (!isInsideBoard(targetX, targetY)) {
             return false;
         }
 
         // Check if destination square is occupied by a piece of the same color
-        if (!boardLayout[targetY][targetX].empty() && isSameColor(boardLayout[targetY][targetX][0] == 'w')) {
+        if (isOwnPiece(position, squareAt(targetX, targetY))) {
             return false;
         }
 
+        // Castling moves the king two squares along its rank; whether the
+        // rights, the path and the squares it crosses allow it is up to the game
+        Square target = squareAt(targetX, targetY);
+        if (position.castlingRights() && rankOf(target) == rankOf(square())
+            && std::abs(fileOf(target) - fileOf(square())) == 2) {
+            return true;
+        }
+
         // Check if the move is one square in any direction
-        int deltaX = std::abs(targetX - static_cast<int>(currentPosition.x / squareSize));
-        int deltaY = std::abs(targetY - static_cast<int>(currentPosition.y / squareSize));
-        return (deltaX <= 1 && deltaY <= 1);
+        return (kingAttacks(square()) & squareBB(target)) != 0;
     }
 
 };
@@ -308,161 +271,443 @@ bool isInsideBoard(int x, int y) {
     return x >= 0 && x < 8 && y >= 0 && y < 8;
 }
 
+// Board coordinates count rows from the top of the window, so row 0 is rank 8
+Square squareAt(int x, int y) {
+    return makeSquare(x, 7 - y);
+}
 
+// Top-left corner of a square in window coordinates
+sf::Vector2f squareOrigin(Square s) {
+    return sf::Vector2f(fileOf(s) * squareSize, (7 - rankOf(s)) * squareSize);
+}
 
+// Pieces a pawn can promote to, in the order the choice lists them
+const PieceType promotionChoices[] = { QUEEN, ROOK, BISHOP, KNIGHT };
 
+// Where choice i of a promotion onto the square is drawn: a column running
+// from the promotion square towards the middle of the board
+sf::Vector2f promotionChoiceOrigin(Square to, int i) {
+    sf::Vector2f origin = squareOrigin(to);
+    origin.y += (rankOf(to) == 7 ? i : -i) * squareSize;
+    return origin;
+}
 
-bool isKingCaptured(const std::string& pieceCode) {
-    return pieceCode == "wk" || pieceCode == "bk"; // Check if the captured piece is a king
+// Index of the promotion choice at a window position, or -1 for none
+int promotionChoiceAt(Square to, const sf::Vector2f& point) {
+    for (int i = 0; i < 4; ++i) {
+        sf::Vector2f origin = promotionChoiceOrigin(to, i);
+        if (point.x >= origin.x && point.x < origin.x + squareSize && point.y >= origin.y
+            && point.y < origin.y + squareSize) {
+            return i;
+        }
+    }
+    return -1;
 }
 
 
-int main() {
-    sf::RenderWindow window(sf::VideoMode(504, 504), "Chess Game", sf::Style::Close);
 
-    std::unordered_map<std::string, sf::Texture> pieceTextures;
-    sf::Font sedan;
-    sf::Text mate;
-    pieceTextures["br1"].loadFromFile("br.png");
-    pieceTextures["bn1"].loadFromFile("bn.png");
-    pieceTextures["bb1"].loadFromFile("bb.png");
-    pieceTextures["br2"].loadFromFile("br.png");
-    pieceTextures["bn2"].loadFromFile("bn.png");
-    pieceTextures["bb2"].loadFromFile("bb.png");
-    pieceTextures["bq"].loadFromFile("bq.png");
-    pieceTextures["bk"].loadFromFile("bk.png");
-    pieceTextures["bp1"].loadFromFile("bp.png");
-    pieceTextures["bp2"].loadFromFile("bp.png");
-    pieceTextures["bp3"].loadFromFile("bp.png");
-    pieceTextures["bp4"].loadFromFile("bp.png");
-    pieceTextures["bp5"].loadFromFile("bp.png");
-    pieceTextures["bp6"].loadFromFile("bp.png");
-    pieceTextures["bp7"].loadFromFile("bp.png");
-    pieceTextures["bp8"].loadFromFile("bp.png");
-
-    sedan.loadFromFile("sedan-regular.ttf");
-    mate.setFont(sedan);
-    mate.setCharacterSize(40);
-    mate.setPosition(16, 112);
-    mate.setFillColor(sf::Color::White);
-    mate.setString("Mate");
 
-    pieceTextures["wr1"].loadFromFile("wr.png");
-    pieceTextures["wn1"].loadFromFile("wn.png");
-    pieceTextures["wb1"].loadFromFile("wb.png");
-    pieceTextures["wr2"].loadFromFile("wr.png");
-    pieceTextures["wn2"].loadFromFile("wn.png");
-    pieceTextures["wb2"].loadFromFile("wb.png");
-    pieceTextures["wq"].loadFromFile("wq.png");
-    pieceTextures["wk"].loadFromFile("wk.png");
-    pieceTextures["wp1"].loadFromFile("wp.png");
-    pieceTextures["wp2"].loadFromFile("wp.png");
-    pieceTextures["wp3"].loadFromFile("wp.png");
-    pieceTextures["wp4"].loadFromFile("wp.png");
-    pieceTextures["wp5"].loadFromFile("wp.png");
-    pieceTextures["wp6"].loadFromFile("wp.png");
-    pieceTextures["wp7"].loadFromFile("wp.png");
-    pieceTextures["wp8"].loadFromFile("wp.png");
 
+std::unique_ptr<ChessPiece> createPiece(Piece piece, const sf::Vector2f& position) {
+    bool isWhite = colorOf(piece) == WHITE;
+    switch (typeOf(piece)) {
+    case PAWN:   return std::make_unique<Pawn>(position, isWhite);
+    case KNIGHT: return std::make_unique<Knight>(position, isWhite);
+    case BISHOP: return std::make_unique<Bishop>(position, isWhite);
+    case ROOK:   return std::make_unique<Rook>(position, isWhite);
+    case QUEEN:  return std::make_unique<Queen>(position, isWhite);
+    default:     return std::make_unique<King>(position, isWhite);
+    }
+}
 
 
+// Bring the pieces in line with the position after a move or a takeback.
+// Pieces that left their square go to the spare pool and are reused for
+// squares that piece type now occupies, so moving, capturing, castling and
+// taking back never destroy one. A new one is only created when the pool
+// has no match, as for a promoted piece.
+void syncPieces(std::unique_ptr<ChessPiece> (&pieces)[SQUARE_NB], std::vector<std::unique_ptr<ChessPiece>>& spare,
+    const Position& position) {
+    for (int s = 0; s < SQUARE_NB; ++s) {
+        if (pieces[s] && pieces[s]->piece() != position.pieceOn(Square(s))) {
+            spare.push_back(std::move(pieces[s]));
+        }
+    }
 
-    sf::Color lightSquareColor(238, 238, 210);
-    sf::Color darkSquareColor(118, 150, 86);
+    for (int s = 0; s < SQUARE_NB; ++s) {
+        Piece piece = position.pieceOn(Square(s));
+        if (piece == NO_PIECE || pieces[s]) {
+            continue;
+        }
+        for (size_t i = 0; i < spare.size(); ++i) {
+            if (spare[i]->piece() == piece) {
+                pieces[s] = std::move(spare[i]);
+                spare[i] = std::move(spare.back());
+                spare.pop_back();
+                break;
+            }
+        }
+        if (!pieces[s]) {
+            pieces[s] = createPiece(piece, squareOrigin(Square(s)));
+        }
+        pieces[s]->place(squareOrigin(Square(s)));
+    }
+}
 
-    std::string boardLayout[8][8] = {
-        {"br1", "bn1", "bb1", "bq", "bk", "bb2", "bn2", "br2"},
-        {"bp1", "bp2", "bp3", "bp4", "bp5", "bp6", "bp7", "bp8"},
-        {"", "", "", "", "", "", "", ""},
-        {"", "", "", "", "", "", "", ""},
-        {"", "", "", "", "", "", "", ""},
-        {"", "", "", "", "", "", "", ""},
-        {"wp1", "wp2", "wp3", "wp4", "wp5", "wp6", "wp7", "wp8"},
-        {"wr1", "wn1", "wb1", "wq", "wk", "wb2", "wn2", "wr2"}
-    };
+// Single-player settings from the command line:
+//   --ai white|black    colour the engine plays
+//   --depth <n>         deepest iteration the engine searches
+//   --movetime <ms>     thinking time per engine move (default 500)
+//   --hash <mb>         transposition table size (default 64)
+//   --threads <n>       search threads sharing the table (default 1)
+//   --fen "<fen>"       start from this position instead of the initial one
+//   --pgn <file>        keep the game written to this file as it is played
+//   --book <file>       opening book in Polyglot format for the engine
+//   --explorer <file>   after each dropped move, show the games of this position index
+//                       that reached the position and how they went on
+//   --tablebases <dir>  endgame tables for the engine; after each move the result
+//                       they give for the position is shown
+//   --fps <n>           most frames per second drawn while a piece is dragged
+//                       (default 60, 0 for no limit)
+//   --vsync on|off      draw in step with the display instead of to --fps
+struct Options {
+    bool aiEnabled = false;
+    Color aiColor = BLACK;
+    SearchLimits limits;
+    size_t hashMb = 64;
+    int threads = 1;
+    std::string fen;
+    std::string pgnPath;
+    std::string explorerPath;
+    std::string bookPath;
+    std::string tablebasePath;
+    unsigned frameLimit = 60;
+    bool vsync = false;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    options.limits.moveTimeMs = 500;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--ai" && (value == "white" || value == "black")) {
+            options.aiEnabled = true;
+            options.aiColor = value == "white" ? WHITE : BLACK;
+        }
+        else if (arg == "--depth" && std::atoi(value.c_str()) > 0) {
+            options.limits.depth = std::atoi(value.c_str());
+        }
+        else if (arg == "--movetime" && std::atoi(value.c_str()) >= 0) {
+            options.limits.moveTimeMs = std::atoi(value.c_str());
+        }
+        else if (arg == "--hash" && std::atoi(value.c_str()) > 0) {
+            options.hashMb = std::atoi(value.c_str());
+        }
+        else if (arg == "--threads" && std::atoi(value.c_str()) > 0) {
+            options.threads = std::atoi(value.c_str());
+        }
+        else if (arg == "--fen") {
+            options.fen = value;
+        }
+        else if (arg == "--pgn") {
+            options.pgnPath = value;
+        }
+        else if (arg == "--book") {
+            options.bookPath = value;
+        }
+        else if (arg == "--explorer") {
+            options.explorerPath = value;
+        }
+        else if (arg == "--tablebases") {
+            options.tablebasePath = value;
+        }
+        else if (arg == "--fps" && std::atoi(value.c_str()) >= 0) {
+            options.frameLimit = std::atoi(value.c_str());
+        }
+        else if (arg == "--vsync" && (value == "on" || value == "off")) {
+            options.vsync = value == "on";
+        }
+        else {
+            std::cerr << "invalid option " << arg << " " << value << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
+// Print what the engine saw when it chose its move
+void reportSearch(const SearchResult& result) {
+    if (result.nodes == 0 && result.bestMove != NO_MOVE) {
+        std::cout << "engine: book move " << moveToUci(result.bestMove) << std::endl;
+        return;
+    }
+    std::cout << "engine: depth " << result.depth << " score " << result.score << " nodes " << result.nodes
+              << " time " << result.seconds << "s tt hits " << result.ttHits << "/" << result.ttProbes
+              << " hashfull " << result.hashfull << " pv";
+    for (Move m : result.pv) {
+        std::cout << " " << moveToUci(m);
+    }
+    std::cout << std::endl;
+}
 
+// Banner shown over the board once the game is over, empty while it goes on
+std::string resultText(const Game& game) {
+    switch (game.status()) {
+    case CHECKMATE:
+        return game.sideToMove() == BLACK ? "CONGRATULATIONS WHITE WINS" : "CONGRATULATIONS BLACK WINS";
+    case STALEMATE:
+        return "DRAW BY STALEMATE";
+    case FIFTY_MOVE_DRAW:
+        return "DRAW BY FIFTY-MOVE RULE";
+    case INSUFFICIENT_MATERIAL:
+        return "DRAW BY INSUFFICIENT MATERIAL";
+    case THREEFOLD_REPETITION:
+        return "DRAW BY REPETITION";
+    default:
+        return "";
+    }
+}
 
-    std::unordered_map<std::string, std::vector<std::unique_ptr<ChessPiece>>> pieces;
+// Print what the indexed games played from the current position
+void reportExplorer(const PositionIndex& index, const Game& game) {
+    IndexedPosition found;
+    if (!index.find(game.position().key(), found)) {
+        std::cout << "explorer: no games" << std::endl;
+        return;
+    }
+    Position position = game.position();
+    std::cout << "explorer: " << found.gameCount << " games";
+    for (uint32_t i = 0; i < found.continuationCount; ++i) {
+        const IndexContinuation& c = found.continuations[i];
+        std::cout << "  " << moveToSan(position, c.move) << " " << c.games << " (+" << c.whiteWins << " =" << c.draws
+                  << " -" << c.blackWins << ")";
+    }
+    std::cout << std::endl;
+}
 
+// Print how the game ends with perfect play, when the tables cover the position
+void reportTablebase(const Tablebases& tablebases, const Game& game) {
+    TbResult result;
+    if (game.status() != ONGOING || !tablebases.probe(game.position(), result)) {
+        return;
+    }
+    if (result.outcome == TB_DRAW) {
+        std::cout << "tablebase: draw" << std::endl;
+        return;
+    }
+    bool whiteWins = (result.outcome == TB_WIN) == (game.sideToMove() == WHITE);
+    std::cout << "tablebase: " << (whiteWins ? "white" : "black") << " mates in " << (result.plies + 1) / 2
+              << std::endl;
+}
 
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            std::string pieceCode = boardLayout[i][j];
-            if (!pieceCode.empty()) {
-                std::unique_ptr<ChessPiece> piece;
-                if (pieceCode[0] == 'b') {
-                    if (pieceCode[1] == 'p') {
-                        piece = std::make_unique<Pawn>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), false);
-                    }
-                    else if (pieceCode[1] == 'n') {
-                        piece = std::make_unique<Knight>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), false);
-                    }
-                    else if (pieceCode[1] == 'b') {
-                        piece = std::make_unique<Bishop>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), false);
-                    }
-                    else if (pieceCode[1] == 'r') {
-                        piece = std::make_unique<Rook>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), false);
-                    }
-                    else if (pieceCode[1] == 'q') {
-                        piece = std::make_unique<Queen>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), false);
-                    }
-                    else if (pieceCode[1] == 'k') {
-                        piece = std::make_unique<King>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), false);
-                    }
-                }
-                else if (pieceCode[0] == 'w') {
-                    if (pieceCode[1] == 'p') {
-                        piece = std::make_unique<Pawn>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), true);
-                    }
-                    else if (pieceCode[1] == 'n') {
-                        piece = std::make_unique<Knight>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), true);
-                    }
-                    else if (pieceCode[1] == 'b') {
-                        piece = std::make_unique<Bishop>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), true);
-                    }
-                    else if (pieceCode[1] == 'r') {
-                        piece = std::make_unique<Rook>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), true);
-                    }
-                    else if (pieceCode[1] == 'q') {
-                        piece = std::make_unique<Queen>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), true);
-                    }
-                    else if (pieceCode[1] == 'k') {
-                        piece = std::make_unique<King>(pieceTextures[pieceCode], sf::Vector2f(j * squareSize, i * squareSize), true);
-                    }
-                }
+std::string pgnResult(const Game& game) {
+    switch (game.status()) {
+    case CHECKMATE:
+        return game.sideToMove() == BLACK ? "1-0" : "0-1";
+    case STALEMATE:
+    case FIFTY_MOVE_DRAW:
+    case INSUFFICIENT_MATERIAL:
+    case THREEFOLD_REPETITION:
+        return "1/2-1/2";
+    default:
+        return "*";
+    }
+}
 
-                if (piece) {
-                    pieces[pieceCode].emplace_back(std::move(piece));
-                }
-            }
+// Rewrite the PGN file with the game so far. Taken-back moves disappear
+// from it along with the board, so the file always matches the game.
+void recordGame(const Options& options, const Game& game) {
+    if (options.pgnPath.empty()) {
+        return;
+    }
+    char date[16];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+    std::string white = options.aiEnabled && options.aiColor == WHITE ? "Engine" : "Player";
+    std::string black = options.aiEnabled && options.aiColor == BLACK ? "Engine" : "Player";
+    std::string result = pgnResult(game);
+
+    std::ofstream out(options.pgnPath, std::ios::trunc);
+    writePgn(out, { { "Event", "Casual game" }, { "Site", "?" }, { "Date", date }, { "Round", "-" }, { "White", white },
+        { "Black", black }, { "Result", result } }, game.startPosition(), game.history(), result);
+    if (!out) {
+        std::cerr << "cannot write " << options.pgnPath << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: chess [--ai white|black] [--depth n] [--movetime ms] [--hash mb] [--threads n] [--fen \"fen\"] [--pgn file] [--book file] [--explorer index] [--tablebases dir] [--fps n] [--vsync on|off]" << std::endl;
+        return 1;
+    }
+
+    initAttacks();
+
+    Game game;
+    if (!options.fen.empty() && !game.setFromFen(options.fen)) {
+        std::cerr << "invalid FEN: " << options.fen << std::endl;
+        return 1;
+    }
+
+    PositionIndex explorer;
+    if (!options.explorerPath.empty() && !explorer.open(options.explorerPath.c_str())) {
+        std::cerr << "cannot open position index " << options.explorerPath << std::endl;
+        return 1;
+    }
+
+    // Images and font are read once, all at the same time, before the first frame
+    Resources resources;
+    if (!resources.load()) {
+        for (const std::string& error : resources.errors()) {
+            std::cerr << error << std::endl;
         }
+        return 1;
     }
+    std::cout << "resources loaded in " << static_cast<int>(resources.loadSeconds() * 1000) << " ms" << std::endl;
+
+    sf::RenderWindow window(sf::VideoMode(504, 504), "Chess Game", sf::Style::Close);
+    window.setVerticalSyncEnabled(options.vsync);
+    window.setFramerateLimit(options.vsync ? 0 : options.frameLimit);
+
+    sf::Text mate;
+    mate.setFont(resources.bannerFont());
+    mate.setCharacterSize(28);
+    mate.setPosition(16, 112);
+    mate.setFillColor(sf::Color::White);
+    mate.setString("Mate");
+
+    // The board and all pieces are drawn from one atlas texture
+    sf::Color lightSquareColor(238, 238, 210);
+    sf::Color darkSquareColor(118, 150, 86);
+    BoardRenderer renderer(squareSize, lightSquareColor, darkSquareColor);
+    if (!renderer.setPieceImages(resources.pieceImages())) {
+        std::cerr << "cannot create the piece texture" << std::endl;
+        return 1;
+    }
+
+    // The engine searches on its own thread while this loop keeps drawing
+    Engine engine(options.hashMb, options.threads);
+    if (!engine.loadBook(options.bookPath)) {
+        std::cerr << "cannot open book " << options.bookPath << std::endl;
+        return 1;
+    }
+    if (!engine.loadTablebases(options.tablebasePath)) {
+        std::cerr << "cannot read tablebases from " << options.tablebasePath << std::endl;
+        return 1;
+    }
+    // The engine's search, and the key of the position it was started for
+    std::future<SearchResult> pendingSearch;
+    Key searchedKey = 0;
+
+    // Drop a search whose position has been changed other than by its reply
+    auto cancelSearch = [&]() {
+        if (pendingSearch.valid()) {
+            engine.stop();
+            pendingSearch.get();
+        }
+    };
+
+    // Sprites are indexed by the square they stand on, like the position itself
+    std::unique_ptr<ChessPiece> pieces[SQUARE_NB];
+    std::vector<std::unique_ptr<ChessPiece>> sparePieces;
+    sparePieces.reserve(SQUARE_NB);
+    syncPieces(pieces, sparePieces, game.position());
     window.display();
 
     bool isMoving = false;
     sf::Vector2f offset;
-    std::string selectedPiece;
+    Square selectedSquare = NO_SQUARE;
     sf::Vector2f startPosition;
 
+    // Frames are drawn only when something changed, and while the engine
+    // thinks the loop looks for its move this often between events
+    bool redraw = true;
+    const auto engineCheckInterval = std::chrono::milliseconds(10);
+
+    // A pawn dropped on its last rank waits there, as this move promoting to
+    // a queen, until a piece is picked from the choice shown over the board
+    Move pendingPromotion = NO_MOVE;
+
+    // Play the move a drop made, or put the piece back where it came from
+    auto finishDrop = [&](Move move) {
+        if (move != NO_MOVE && game.playMove(move)) {
+            syncPieces(pieces, sparePieces, game.position());
+            recordGame(options, game);
+            if (explorer.positions() > 0) {
+                reportExplorer(explorer, game);
+            }
+            reportTablebase(engine.tablebases(), game);
+        }
+        else {
+            pieces[selectedSquare]->move(startPosition, game.sideToMove() == WHITE);
+        }
+    };
+
     while (window.isOpen()) {
+        // The board only changes on an event or when the engine moves, so
+        // rather than redraw the same frame, sleep until one of them happens
         sf::Event event;
-        while (window.pollEvent(event)) {
+        bool haveEvent = window.pollEvent(event);
+        if (!haveEvent && !redraw) {
+            // A finished search is picked up below, unless a piece is held
+            if (!isMoving && pendingSearch.valid()) {
+                pendingSearch.wait_for(engineCheckInterval);
+            }
+            else {
+                haveEvent = window.waitEvent(event);
+            }
+        }
+
+        for (; haveEvent; haveEvent = window.pollEvent(event)) {
+            redraw = true;
             if (event.type == sf::Event::Closed) {
                 window.close();
             }
 
+            // Escape, or a click off the choice, cancels a promotion
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape
+                && pendingPromotion != NO_MOVE) {
+                finishDrop(NO_MOVE);
+                pendingPromotion = NO_MOVE;
+            }
+
+            // Backspace takes back the last move, and the engine's reply along with it
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::BackSpace && !isMoving
+                && pendingPromotion == NO_MOVE) {
+                // A search of the position being taken back is of no further use
+                cancelSearch();
+                if (game.undoMove()) {
+                    if (options.aiEnabled && game.sideToMove() == options.aiColor) {
+                        game.undoMove();
+                    }
+                    syncPieces(pieces, sparePieces, game.position());
+                    recordGame(options, game);
+                }
+            }
+
             if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
+                if (event.mouseButton.button == sf::Mouse::Left && pendingPromotion != NO_MOVE) {
+                    sf::Vector2f mousePosition = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+                    Square from = moveFrom(pendingPromotion);
+                    Square to = moveTo(pendingPromotion);
+                    int choice = promotionChoiceAt(to, mousePosition);
+                    finishDrop(choice >= 0 ? game.findMove(from, to, promotionChoices[choice]) : NO_MOVE);
+                    pendingPromotion = NO_MOVE;
+                }
+                else if (event.mouseButton.button == sf::Mouse::Left) {
                     sf::Vector2f mousePosition = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
                     int clickedX = static_cast<int>(mousePosition.x / squareSize);
                     int clickedY = static_cast<int>(mousePosition.y / squareSize);
-                    std::string pieceCode = boardLayout[clickedY][clickedX];
-                    if (!pieceCode.empty()) {
-                        selectedPiece = pieceCode;
+                    if (isInsideBoard(clickedX, clickedY) && pieces[squareAt(clickedX, clickedY)]) {
+                        selectedSquare = squareAt(clickedX, clickedY);
                         isMoving = true;
-                        offset = pieces[selectedPiece][0]->getPosition() - mousePosition;
-                        startPosition = pieces[selectedPiece][0]->getPosition();
+                        offset = pieces[selectedSquare]->getPosition() - mousePosition;
+                        startPosition = pieces[selectedSquare]->getPosition();
                     }
                 }
             }
@@ -473,120 +718,103 @@ int main() {
                     sf::Vector2f dropPosition = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
                     int dropX = static_cast<int>(dropPosition.x / squareSize);
                     int dropY = static_cast<int>(dropPosition.y / squareSize);
-  
-
-                    if (isInsideBoard(dropX, dropY) && pieces[selectedPiece][0]->isValidMove(dropX, dropY, boardLayout) && (pieces[selectedPiece][0]->getWhite() == turn)) {
-                        
- 
-
-                        if (boardLayout[dropY][dropX].empty() ) {
-
-                            boardLayout[dropY][dropX] = selectedPiece;
-                            boardLayout[static_cast<int>(startPosition.y / squareSize)][static_cast<int>(startPosition.x / squareSize)] = "";
-                            pieces[selectedPiece][0]->move(sf::Vector2f(dropX * squareSize, dropY * squareSize), turn);
-                            turn = !turn;
-                            pieces[selectedPiece][0]->setPos();
-
-                           
-
-                            
-                          
-
-                        }
-                        else {
-                            std::string capturedPiece = boardLayout[dropY][dropX];
-                            if (isKingCaptured(capturedPiece)) {
-                                sf::RenderWindow result(sf::VideoMode(786, 400), "Result", sf::Style::Close);
-                                while (result.isOpen()) {
-                                    sf::Event e;
-                                    while (result.pollEvent(e)) {
-                                        if (e.type == sf::Event::Closed) {
-                                            result.close();
-                                            window.close();
-                                        }
-
-
-
-                                    }
-                                    if (turn) {
-                                        mate.setString("CONGRATULATIONS WHITE WINS");
-                                    }
-                                    else
-                                    {
-                                        mate.setString("CONGRATULATIONS BLACK WINS");
-                                    };
-
-                                    result.clear();
-                                    result.draw(mate);
-                                    result.display();
-
-
-
-
-                                    window.close();
-                                }
-                            }
-                            else {
-                                // Capture the opponent's piece
-                                pieces[capturedPiece].clear();
-                                boardLayout[dropY][dropX] = selectedPiece;
-                                boardLayout[static_cast<int>(startPosition.y / squareSize)][static_cast<int>(startPosition.x / squareSize)] = "";
-                                pieces[selectedPiece][0]->move(sf::Vector2f(dropX * squareSize, dropY * squareSize), turn);
-                                turn = !turn;
-                                pieces[selectedPiece][0]->setPos();
-                          
-                   
-                            }
-                        }
+                    bool turn = game.sideToMove() == WHITE;
+                    bool engineToMove = options.aiEnabled && game.sideToMove() == options.aiColor;
+
+                    // The piece's own movement rules reject most drops cheaply;
+                    // the game then decides whether the move is actually legal.
+                    // The engine's pieces are its own to move.
+                    Move move = NO_MOVE;
+                    if (!engineToMove && isInsideBoard(dropX, dropY) && pieces[selectedSquare]->getWhite() == turn
+                        && pieces[selectedSquare]->isValidMove(dropX, dropY, game.position())) {
+                        move = game.findMove(selectedSquare, squareAt(dropX, dropY));
+                    }
+
+                    if (move != NO_MOVE && isPromotion(move)) {
+                        pendingPromotion = move;
                     }
                     else {
-                        // Move the piece back to its original position if the move is invalid
-                        pieces[selectedPiece][0]->move(startPosition, turn);
+                        finishDrop(move);
                     }
                 }
             }
-
-
         }
 
-
-
+        // Start the engine on its turn and pick up its move once the search is
+        // done, but never while a piece is held, as the move may capture it.
+        // A move found for any other position than the current one is dropped.
+        if (options.aiEnabled && game.status() == ONGOING && game.sideToMove() == options.aiColor) {
+            if (!pendingSearch.valid()) {
+                searchedKey = game.position().key();
+                pendingSearch = engine.start(game.position(), options.limits);
+            }
+            else if (!isMoving && pendingSearch.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                SearchResult result = pendingSearch.get();
+                reportSearch(result);
+                if (searchedKey == game.position().key() && game.playMove(result.bestMove)) {
+                    redraw = true;
+                    syncPieces(pieces, sparePieces, game.position());
+                    recordGame(options, game);
+                    reportTablebase(engine.tablebases(), game);
+                }
+            }
+        }
+        else {
+            // Not the engine's turn, so nothing it searched still applies, and
+            // a finished future left waiting would keep the loop from sleeping
+            cancelSearch();
+        }
 
         if (isMoving) {
             sf::Vector2f mousePosition(window.mapPixelToCoords(sf::Mouse::getPosition(window)));
             if (mousePosition.x >= 0 && mousePosition.x < 8 * squareSize &&
                 mousePosition.y >= 0 && mousePosition.y < 8 * squareSize) {
-                pieces[selectedPiece][0]->move(mousePosition + offset, turn);
+                pieces[selectedSquare]->move(mousePosition + offset, game.sideToMove() == WHITE);
             }
         }
 
+        if (!redraw) {
+            continue;
+        }
+        redraw = false;
         window.clear();
 
-        for (int i = 0; i < 8; ++i) {
-            for (int j = 0; j < 8; ++j) {
+        // A held piece, or a pawn waiting for its promotion, is drawn apart
+        // from the rest, at the point where it is held
+        Square lifted = isMoving || pendingPromotion != NO_MOVE ? selectedSquare : NO_SQUARE;
+        renderer.update(game.position(), lifted);
+        if (lifted != NO_SQUARE) {
+            renderer.draw(window, game.position().pieceOn(lifted), pieces[lifted]->curr);
+        }
+        else {
+            renderer.draw(window);
+        }
+
+        if (pendingPromotion != NO_MOVE) {
+            sf::RectangleShape shade(sf::Vector2f(8 * squareSize, 8 * squareSize));
+            shade.setFillColor(sf::Color(0, 0, 0, 120));
+            window.draw(shade);
+            for (int i = 0; i < 4; ++i) {
+                sf::Vector2f origin = promotionChoiceOrigin(moveTo(pendingPromotion), i);
                 sf::RectangleShape square(sf::Vector2f(squareSize, squareSize));
-                square.setPosition(j * squareSize, i * squareSize);
-                if ((i + j) % 2 == 1) {
-                    square.setFillColor(darkSquareColor);
-                }
-                else {
-                    square.setFillColor(lightSquareColor);
-                }
+                square.setPosition(origin);
+                square.setFillColor(lightSquareColor);
                 window.draw(square);
+                Piece choice = makePiece(game.sideToMove(), promotionChoices[i]);
+                renderer.drawPiece(window, choice, origin);
             }
         }
 
-        for (auto& piecePair : pieces) {
-            for (auto& piece : piecePair.second) {
-                const sf::Sprite& originalSprite = piece->sprite;
-                sf::Sprite pieceSprite(originalSprite);
-                float scale = squareSize / std::max(originalSprite.getLocalBounds().width, originalSprite.getLocalBounds().height);
-                pieceSprite.setScale(scale, scale);
-                float offsetX = (squareSize - originalSprite.getLocalBounds().width * scale) / 2;
-                float offsetY = (squareSize - originalSprite.getLocalBounds().height * scale) / 2;
-                pieceSprite.setPosition(piece->curr.x + offsetX, piece->curr.y + offsetY);
-                window.draw(pieceSprite);
-            }
+        // The result stays on the board until the window is closed or a move is taken back
+        std::string banner = resultText(game);
+        if (!banner.empty()) {
+            sf::RectangleShape shade(sf::Vector2f(8 * squareSize, 8 * squareSize));
+            shade.setFillColor(sf::Color(0, 0, 0, 160));
+            window.draw(shade);
+            mate.setString(banner);
+            sf::FloatRect bounds = mate.getLocalBounds();
+            mate.setPosition((8 * squareSize - bounds.width) / 2 - bounds.left, (8 * squareSize - bounds.height) / 2 - bounds.top);
+            window.draw(mate);
         }
         window.display();
     }
@@ -0,0 +1,39 @@
+#include "Resources.h"
+
+#include <chrono>
+#include <future>
+
+// Image of each piece, indexed by Piece
+static const char* const pieceFiles[PIECE_NB] = {
+    "wp.png", "wn.png", "wb.png", "wr.png", "wq.png", "wk.png",
+    "bp.png", "bn.png", "bb.png", "br.png", "bq.png", "bk.png"
+};
+
+static const char* const bannerFontFile = "Sedan-Regular.ttf";
+
+bool Resources::load(const std::string& directory) {
+    auto start = std::chrono::steady_clock::now();
+    failures.clear();
+
+    // Each file is decoded into its own slot, so the loads share nothing
+    std::vector<std::future<bool>> pending;
+    std::vector<std::string> paths;
+    for (int p = 0; p < PIECE_NB; ++p) {
+        paths.push_back(directory + pieceFiles[p]);
+        pending.push_back(std::async(std::launch::async, [this, p, path = paths.back()]() {
+            return images[p].loadFromFile(path);
+        }));
+    }
+    paths.push_back(directory + bannerFontFile);
+    pending.push_back(std::async(std::launch::async, [this, path = paths.back()]() {
+        return banner.loadFromFile(path);
+    }));
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (!pending[i].get()) {
+            failures.push_back("cannot load " + paths[i]);
+        }
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return failures.empty();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+// The files the window draws with, each read once at startup. The piece
+// images are kept by Piece and the font by role, and everything that uses
+// them holds a reference into this cache. Files are decoded on worker
+// threads in parallel; uploading to the GPU is left to whoever draws them,
+// on the thread that owns the window.
+class Resources {
+public:
+    typedef sf::Image PieceImages[PIECE_NB];
+
+    // Read every file from the directory, which is empty or ends in a
+    // separator. Returns false if any file could not be read; errors() then
+    // names each one.
+    bool load(const std::string& directory = "");
+
+    const PieceImages& pieceImages() const {
+        return images;
+    }
+
+    // Typeface of the result banner
+    const sf::Font& bannerFont() const {
+        return banner;
+    }
+
+    const std::vector<std::string>& errors() const {
+        return failures;
+    }
+
+    // How long the last load() took
+    double loadSeconds() const {
+        return seconds;
+    }
+
+private:
+    PieceImages images;
+    sf::Font banner;
+    std::vector<std::string> failures;
+    double seconds = 0;
+};
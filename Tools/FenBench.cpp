@@ -0,0 +1,175 @@
+// FEN throughput benchmark and round-trip check.
+//
+//   fenbench <file>              parse every line of a FEN file, report MB/s
+//   fenbench --selftest [games]  play random games, check that every position
+//                                survives writeFen/setFromFen unchanged, that
+//                                impossible positions are refused, then time
+//                                parsing of the generated records
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MoveGen.h"
+#include "SelfTest.h"
+
+// Parse every newline-separated record in the buffer, returning how many failed
+static uint64_t parseAll(std::string_view text, uint64_t& lines, Key& checksum) {
+    uint64_t failures = 0;
+    Position position;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        if (end > begin) {
+            ++lines;
+            if (position.setFromFen(text.substr(begin, end - begin))) {
+                checksum ^= position.key();
+            }
+            else {
+                ++failures;
+            }
+        }
+        begin = end + 1;
+    }
+    return failures;
+}
+
+static void reportThroughput(size_t bytes, uint64_t lines, double seconds) {
+    std::printf("%llu records, %.1f MB in %.3f s: %.0f MB/s, %.0f records/s\n", static_cast<unsigned long long>(lines),
+        bytes / 1e6, seconds, seconds > 0 ? bytes / 1e6 / seconds : 0.0, seconds > 0 ? lines / seconds : 0.0);
+}
+
+static int runFile(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+    std::string text;
+    char chunk[1 << 16];
+    size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, got);
+    }
+    std::fclose(file);
+
+    uint64_t lines = 0;
+    Key checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t failures = parseAll(text, lines, checksum);
+    reportThroughput(text.size(), lines, secondsSince(start));
+    std::printf("%llu invalid record(s), key checksum %016llx\n", static_cast<unsigned long long>(failures),
+        static_cast<unsigned long long>(checksum));
+    return 0;
+}
+
+// Records the parser must refuse: pawns on a back rank, a missing or extra
+// king, the side not to move in check, an en-passant square on the wrong rank
+static const char* const rejectedFens[] = {
+    "4k2P/8/8/8/8/8/8/4K3 w - - 0 1",
+    "4k3/8/8/8/8/8/8/p3K3 b - - 0 1",
+    "8/8/8/8/8/8/8/4K3 w - - 0 1",
+    "4k3/8/8/8/8/8/8/3KK3 w - - 0 1",
+    "4k3/8/8/8/8/8/8/4K2r b - - 0 1",
+    "4k3/4R3/8/8/8/8/8/4K3 w - - 0 1",
+    "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e3 0 1",
+    "4k3/8/8/8/8/8/3P1P2/4K3 w - e3 0 1",
+};
+
+// Records whose en-passant square is dropped as no pawn can have just skipped it
+static const char* const noEnPassantFens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq e3 0 1",
+    "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1",
+    "4k3/4r3/8/3Pp3/8/8/8/4K3 w - e6 0 1",
+};
+
+static int checkRejections() {
+    int failures = 0;
+    for (const char* fen : rejectedFens) {
+        Position position;
+        if (position.setFromFen(fen)) {
+            ++failures;
+            std::printf("accepted impossible position: %s\n", fen);
+        }
+    }
+    for (const char* fen : noEnPassantFens) {
+        Position position;
+        if (!position.setFromFen(fen) || position.enPassantSquare() != NO_SQUARE) {
+            ++failures;
+            std::printf("kept impossible en-passant square: %s\n", fen);
+        }
+    }
+    return failures;
+}
+
+static int runSelfTest(int games) {
+    TestRandom random;
+
+    std::string corpus;
+    uint64_t checked = 0;
+    int failures = 0;
+    char buffer[Position::MAX_FEN_LENGTH];
+
+    for (int i = 0; i < games; ++i) {
+        Position position;
+        position.setFromFen(seedFens[i % SEED_FEN_COUNT]);
+        RandomGame game = randomGame(position, 200, random);
+
+        // Every position of the game, the start and the end included
+        for (size_t ply = 0;; ++ply) {
+            size_t length = position.writeFen(buffer);
+            corpus.append(buffer, length);
+            corpus += '\n';
+
+            Position copy;
+            char again[Position::MAX_FEN_LENGTH];
+            if (!copy.setFromFen(std::string_view(buffer, length)) || copy.key() != position.key()
+                || copy.writeFen(again) != length || std::memcmp(again, buffer, length) != 0) {
+                if (++failures <= 10) {
+                    std::printf("round trip failed: %s\n", buffer);
+                }
+            }
+            ++checked;
+
+            if (ply == game.moves.size()) {
+                break;
+            }
+            position.makeMove(game.moves[ply]);
+        }
+    }
+    failures += checkRejections();
+    std::printf("%llu positions round-tripped, %d failure(s)\n", static_cast<unsigned long long>(checked), failures);
+
+    // Time parsing alone over the corpus a few times to smooth out noise
+    const int passes = 5;
+    uint64_t lines = 0;
+    Key checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        parseAll(corpus, lines, checksum);
+    }
+    reportThroughput(corpus.size() * passes, lines, secondsSince(start));
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    if (argc >= 2 && std::string(argv[1]) == "--selftest") {
+        int games = argc >= 3 ? std::atoi(argv[2]) : 2000;
+        return runSelfTest(games < 1 ? 1 : games);
+    }
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: fenbench <file>\n       fenbench --selftest [games]\n");
+        return 2;
+    }
+    return runFile(argv[1]);
+}
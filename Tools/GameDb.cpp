@@ -0,0 +1,271 @@
+// Binary game archive tool.
+//
+//   gamedb convert <in.pgn> <out.cga>   import a PGN file into an archive
+//   gamedb replay <file.cga>            replay every game, report games per second
+//   gamedb show <file.cga> <number>     print one game, counted from 1, as PGN
+//   gamedb --selftest [games]           archive random games, check that every
+//                                       move reads back, compare load times
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GameArchive.h"
+#include "MoveGen.h"
+#include "Pgn.h"
+#include "SelfTest.h"
+
+static GameResult resultFromToken(std::string_view token) {
+    return token == "1-0" ? WHITE_WINS : token == "0-1" ? BLACK_WINS : token == "1/2-1/2" ? DRAWN : RESULT_UNKNOWN;
+}
+
+static const char* resultToken(GameResult result) {
+    static const char* const tokens[] = { "*", "1-0", "0-1", "1/2-1/2" };
+    return tokens[result <= DRAWN ? result : RESULT_UNKNOWN];
+}
+
+// Leading decimal digits of a tag value, zero when there are none
+static uint32_t tagNumber(std::string_view value) {
+    uint32_t number = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9' || number > 100000000) {
+            break;
+        }
+        number = number * 10 + uint32_t(c - '0');
+    }
+    return number;
+}
+
+// "1972.07.??" as 19720700
+static uint32_t tagDate(std::string_view value) {
+    if (value.size() != 10) {
+        return 0;
+    }
+    return tagNumber(value.substr(0, 4)) * 10000 + tagNumber(value.substr(5, 2)) * 100 + tagNumber(value.substr(8, 2));
+}
+
+static int runConvert(const char* inPath, const char* outPath) {
+    MappedFile input;
+    if (!input.open(inPath, SEQUENTIAL_ACCESS)) {
+        std::fprintf(stderr, "cannot open %s\n", inPath);
+        return 2;
+    }
+    GameArchiveWriter writer;
+    if (!writer.open(outPath)) {
+        std::fprintf(stderr, "cannot create %s\n", outPath);
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PgnReader reader(input.text());
+    std::vector<Move> moves;
+    uint64_t games = 0, skipped = 0, plies = 0;
+    while (reader.nextGame()) {
+        Position startPosition = reader.position();
+        moves.clear();
+        Move m;
+        while (reader.nextMove(m)) {
+            moves.push_back(m);
+        }
+        if (reader.failed()) {
+            ++skipped;
+            continue;
+        }
+
+        ArchiveGameHeader info = {};
+        info.date = tagDate(reader.tag("Date"));
+        info.whiteElo = uint16_t(tagNumber(reader.tag("WhiteElo")));
+        info.blackElo = uint16_t(tagNumber(reader.tag("BlackElo")));
+        info.result = resultFromToken(reader.result().empty() ? reader.tag("Result") : reader.result());
+        writer.add(info, startPosition, moves);
+        ++games;
+        plies += moves.size();
+    }
+    if (!writer.close()) {
+        std::fprintf(stderr, "error writing %s\n", outPath);
+        return 2;
+    }
+    std::printf("%llu games, %llu plies archived in %.3f s, %llu unreadable game(s) skipped\n",
+        static_cast<unsigned long long>(games), static_cast<unsigned long long>(plies), secondsSince(start),
+        static_cast<unsigned long long>(skipped));
+    return 0;
+}
+
+static int runReplay(const char* path) {
+    auto start = std::chrono::steady_clock::now();
+    GameArchive archive;
+    if (!archive.open(path)) {
+        std::fprintf(stderr, "cannot open %s or it is not a game archive\n", path);
+        return 2;
+    }
+    double openSeconds = secondsSince(start);
+
+    uint64_t plies = 0, bad = 0;
+    Key checksum = 0;
+    Position position;
+    for (uint64_t i = 0; i < archive.size(); ++i) {
+        ArchiveGame game;
+        if (!archive.game(i, game) || !GameArchive::replay(game, position)) {
+            ++bad;
+            continue;
+        }
+        plies += game.header.plies;
+        checksum ^= position.key();
+    }
+    double seconds = secondsSince(start);
+    std::printf("opened in %.6f s; %llu games, %llu plies replayed in %.3f s: %.0f games/s, %.0f plies/s\n", openSeconds,
+        static_cast<unsigned long long>(archive.size()), static_cast<unsigned long long>(plies), seconds,
+        seconds > 0 ? archive.size() / seconds : 0.0, seconds > 0 ? plies / seconds : 0.0);
+    std::printf("%llu damaged game(s), key checksum %016llx\n", static_cast<unsigned long long>(bad),
+        static_cast<unsigned long long>(checksum));
+    return bad == 0 ? 0 : 1;
+}
+
+static int runShow(const char* path, uint64_t number) {
+    GameArchive archive;
+    if (!archive.open(path)) {
+        std::fprintf(stderr, "cannot open %s or it is not a game archive\n", path);
+        return 2;
+    }
+    ArchiveGame game;
+    Position start, end;
+    std::vector<Move> moves;
+    if (number < 1 || !archive.game(number - 1, game) || !GameArchive::startPosition(game, start)
+        || !GameArchive::replay(game, end, &moves)) {
+        std::fprintf(stderr, "no game %llu in %s\n", static_cast<unsigned long long>(number), path);
+        return 2;
+    }
+
+    // Unknown parts of the date come back as question marks
+    uint32_t d = game.header.date;
+    std::string date = (d / 10000 ? std::to_string(d / 10000) : "????") + "."
+        + (d / 100 % 100 ? std::to_string(d / 100 % 100 + 100).substr(1) : "??") + "."
+        + (d % 100 ? std::to_string(d % 100 + 100).substr(1) : "??");
+    std::vector<PgnTag> tags = { { "Date", date }, { "Result", resultToken(game.header.result) } };
+    if (game.header.whiteElo) {
+        tags.push_back({ "WhiteElo", std::to_string(game.header.whiteElo) });
+    }
+    if (game.header.blackElo) {
+        tags.push_back({ "BlackElo", std::to_string(game.header.blackElo) });
+    }
+    writePgn(std::cout, tags, start, moves, resultToken(game.header.result));
+    return 0;
+}
+
+static int runSelfTest(int games) {
+    const char* const path = "gamedb-selftest.cga";
+    TestRandom random;
+
+    GameArchiveWriter writer;
+    if (!writer.open(path)) {
+        std::fprintf(stderr, "cannot create %s\n", path);
+        return 2;
+    }
+    std::ostringstream pgn;
+    std::vector<std::vector<Move>> played;
+    std::vector<Key> finalKeys;
+    uint64_t plies = 0;
+    for (int i = 0; i < games; ++i) {
+        Position start;
+        start.setFromFen(seedFens[i % SEED_FEN_COUNT]);
+        RandomGame game = randomGame(start, 300, random);
+        const std::vector<Move>& moves = game.moves;
+
+        ArchiveGameHeader info = {};
+        info.date = 20240000 + uint32_t(i % 12 + 1) * 100 + uint32_t(i % 28 + 1);
+        info.whiteElo = uint16_t(1000 + i % 1800);
+        info.result = GameResult(i % 4);
+        writer.add(info, start, moves);
+        writePgn(pgn, {}, start, moves, resultToken(info.result));
+        played.push_back(moves);
+        finalKeys.push_back(game.end.key());
+        plies += moves.size();
+    }
+    if (!writer.close()) {
+        std::fprintf(stderr, "error writing %s\n", path);
+        return 2;
+    }
+
+    int failures = 0;
+    GameArchive archive;
+    if (!archive.open(path) || archive.size() != uint64_t(games)) {
+        std::printf("archive did not open with %d games\n", games);
+        std::remove(path);
+        return 1;
+    }
+
+    // Visit the games out of order, as a service opening them by number would
+    std::vector<Move> moves;
+    Position position;
+    for (int i = 0; i < games; ++i) {
+        int number = int((uint64_t(i) * 7919) % uint64_t(games));
+        ArchiveGame game;
+        bool ok = archive.game(uint64_t(number), game) && GameArchive::replay(game, position, &moves)
+            && moves == played[number] && position.key() == finalKeys[number] && game.header.result == GameResult(number % 4)
+            && game.header.whiteElo == 1000 + number % 1800 && game.header.date % 100 == uint32_t(number % 28 + 1);
+        if (!ok && ++failures <= 10) {
+            std::printf("game %d did not read back\n", number + 1);
+        }
+    }
+    ArchiveGame beyond;
+    failures += archive.game(uint64_t(games), beyond) ? 1 : 0;
+    std::printf("%d games, %llu plies round-tripped, %d failure(s)\n", games, static_cast<unsigned long long>(plies),
+        failures);
+
+    // The same games loaded from PGN text and from the archive
+    std::string text = pgn.str();
+    auto start = std::chrono::steady_clock::now();
+    PgnReader reader(text);
+    while (reader.nextGame()) {
+        Move m;
+        while (reader.nextMove(m)) {
+        }
+    }
+    double pgnSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < archive.size(); ++i) {
+        ArchiveGame game;
+        archive.game(i, game);
+        GameArchive::replay(game, position);
+    }
+    double archiveSeconds = secondsSince(start);
+
+    std::printf("PGN: %zu bytes read in %.3f s; archive: %llu bytes replayed in %.3f s, %.2f bytes per ply\n",
+        text.size(), pgnSeconds, static_cast<unsigned long long>(archive.bytes()), archiveSeconds,
+        plies ? double(archive.bytes()) / plies : 0.0);
+    archive.close();
+    std::remove(path);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    std::string command = argc >= 2 ? argv[1] : "";
+    if (command == "--selftest") {
+        int games = argc >= 3 ? std::atoi(argv[2]) : 1000;
+        return runSelfTest(games < 1 ? 1 : games);
+    }
+    if (command == "convert" && argc == 4) {
+        return runConvert(argv[2], argv[3]);
+    }
+    if (command == "replay" && argc == 3) {
+        return runReplay(argv[2]);
+    }
+    if (command == "show" && argc == 4) {
+        return runShow(argv[2], std::strtoull(argv[3], nullptr, 10));
+    }
+    std::fprintf(stderr,
+        "usage: gamedb convert <in.pgn> <out.cga>\n"
+        "       gamedb replay <file.cga>\n"
+        "       gamedb show <file.cga> <number>\n"
+        "       gamedb --selftest [games]\n");
+    return 2;
+}
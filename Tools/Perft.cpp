@@ -0,0 +1,298 @@
+// Headless perft driver: counts the leaf nodes of the legal move tree to
+// check the move generator against published numbers and to measure its
+// throughput without opening a window.
+//
+//   perft <depth> [fen]            divide by root move, total, nodes per second
+//   perft --suite [max-nodes]      run the reference positions, exit 1 on mismatch
+//
+// The suite also walks the smaller trees comparing the incrementally updated
+// Zobrist key with one recomputed from scratch after every make and unmake,
+// and the early-exit legal move test with the full move list at every node.
+// It ends by checking the game status of known final positions and of
+// repeated ones, and timing the status test.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "MoveGen.h"
+#include "Notation.h"
+#include "SelfTest.h"
+
+static const char* const startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+// Reference counts from the Chess Programming Wiki perft results page
+static const PerftCase referenceCases[] = {
+    { "startpos", startFen, 1, 20 },
+    { "startpos", startFen, 2, 400 },
+    { "startpos", startFen, 3, 8902 },
+    { "startpos", startFen, 4, 197281 },
+    { "startpos", startFen, 5, 4865609 },
+    { "startpos", startFen, 6, 119060324 },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 1, 48 },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 2, 2039 },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862 },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603 },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 1, 14 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 2, 191 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3, 2812 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 4, 43238 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083 },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 7, 178633661 },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 1, 6 },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 2, 264 },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467 },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292 },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 1, 44 },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 2, 1486 },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379 },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487 },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194 },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 1, 46 },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 2, 2079 },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89890 },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594 },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551 },
+};
+
+// Leaves at depth 1 are counted straight from the move list (bulk counting)
+static uint64_t perft(Position& position, int depth) {
+    MoveList moves;
+    generateMoves(position, moves);
+    if (depth <= 1) {
+        return depth == 1 ? moves.size() : 1;
+    }
+
+    uint64_t nodes = 0;
+    for (Move m : moves) {
+        position.makeMove(m);
+        nodes += perft(position, depth - 1);
+        position.unmakeMove();
+    }
+    return nodes;
+}
+
+// Number of nodes whose incremental key disagrees with a full recompute, or
+// where hasLegalMove disagrees with the move list
+static uint64_t consistencyErrors(Position& position, int depth) {
+    uint64_t bad = position.key() != position.computeKey() ? 1 : 0;
+    MoveList moves;
+    generateMoves(position, moves);
+    bad += hasLegalMove(position) != (moves.size() > 0) ? 1 : 0;
+    if (depth == 0) {
+        return bad;
+    }
+
+    for (Move m : moves) {
+        Key before = position.key();
+        position.makeMove(m);
+        bad += consistencyErrors(position, depth - 1);
+        position.unmakeMove();
+        bad += position.key() != before ? 1 : 0;
+    }
+    return bad;
+}
+
+static int runDivide(int depth, const std::string& fen) {
+    Position position;
+    if (!position.setFromFen(fen)) {
+        std::fprintf(stderr, "invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    MoveList moves;
+    generateMoves(position, moves);
+    uint64_t total = 0;
+    for (Move m : moves) {
+        position.makeMove(m);
+        uint64_t nodes = perft(position, depth - 1);
+        position.unmakeMove();
+        total += nodes;
+        std::printf("%s: %llu\n", moveToUci(m).c_str(), static_cast<unsigned long long>(nodes));
+    }
+    double seconds = secondsSince(start);
+
+    std::printf("\nNodes: %llu\nTime: %.3f s\nNPS: %.0f\n", static_cast<unsigned long long>(total), seconds,
+        seconds > 0 ? total / seconds : 0.0);
+    return 0;
+}
+
+struct StatusCase {
+    const char* fen;
+    GameStatus status;
+};
+
+static const StatusCase statusCases[] = {
+    { startFen, ONGOING },
+    { "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3", CHECKMATE },
+    { "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", ONGOING },
+    { "R5k1/5ppp/8/8/8/8/8/6K1 b - - 1 1", CHECKMATE },
+    { "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", STALEMATE },
+    { "k7/P7/K7/8/8/8/8/8 b - - 0 1", STALEMATE },
+    // Black's only move is en passant, and then not even that once the pawn is pinned
+    { "8/8/8/8/3Pp3/4P3/5K2/5N1k b - d3 0 1", ONGOING },
+    { "8/8/2B5/8/3Pp3/4P3/5K2/5N1k b - d3 0 1", STALEMATE },
+    { "8/8/8/8/8/8/8/k1K5 w - - 0 1", INSUFFICIENT_MATERIAL },
+    { "8/8/8/8/8/8/4N3/k1K5 w - - 0 1", INSUFFICIENT_MATERIAL },
+    { "8/8/8/8/2b5/8/4B3/k1K5 w - - 0 1", INSUFFICIENT_MATERIAL },
+    { "8/8/8/8/3b4/8/4B3/k1K5 w - - 0 1", ONGOING },
+    { "8/8/8/8/8/8/3NN3/k1K5 w - - 0 1", ONGOING },
+    { "8/8/8/8/8/4R3/8/k1K5 b - - 100 80", FIFTY_MOVE_DRAW },
+    { "8/8/8/8/8/4R3/8/k1K5 b - - 99 80", ONGOING },
+    { "k7/2K5/8/8/8/8/8/R7 b - - 100 80", CHECKMATE },
+};
+
+// Check the status of known positions, then time the status test
+static int runStatusChecks() {
+    int failures = 0;
+    Position positions[sizeof(statusCases) / sizeof(statusCases[0])];
+    int count = 0;
+    for (const StatusCase& test : statusCases) {
+        Position& position = positions[count++];
+        position.setFromFen(test.fen);
+        GameStatus status = positionStatus(position);
+        if (status != test.status) {
+            ++failures;
+            std::printf("status of %s: %d, expected %d\n", test.fen, status, test.status);
+        }
+    }
+
+    // Knights out and back: every position from the fifth ply on has been
+    // seen before, and the start comes round a third time after eight. A
+    // pawn move starts the count again, and a null move hides what came
+    // before it.
+    static const char* const shuffle[] = { "Nf3", "Nf6", "Ng1", "Ng8" };
+    Position walk;
+    walk.setStartPosition();
+    int expected[] = { 0, 0, 0, 1, 1, 1, 1, 2 };
+    for (int ply = 0; ply < 8; ++ply) {
+        walk.makeMove(moveFromSan(walk, shuffle[ply % 4]));
+        int seen = walk.isRepetition(2) ? 2 : walk.isRepetition(1) ? 1 : 0;
+        GameStatus status = positionStatus(walk);
+        if (seen != expected[ply] || (status == THREEFOLD_REPETITION) != (seen == 2)) {
+            ++failures;
+            std::printf("repetition after %d plies: %d earlier occurrence(s) found, expected %d\n", ply + 1, seen,
+                expected[ply]);
+        }
+    }
+    walk.makeMove(moveFromSan(walk, "e4"));
+    walk.makeMove(moveFromSan(walk, "e5"));
+    for (int ply = 0; ply < 4; ++ply) {
+        walk.makeMove(moveFromSan(walk, shuffle[ply]));
+    }
+    failures += walk.isRepetition() ? 0 : 1;
+    walk.makeMove(moveFromSan(walk, "Nf3"));
+    walk.makeNullMove();
+    walk.makeMove(moveFromSan(walk, "Ng1"));
+    walk.makeNullMove();
+    failures += walk.isRepetition() ? 1 : 0;
+
+    // A copy carries the undo records in use, also once the ring has wrapped
+    Position played;
+    played.setStartPosition();
+    for (int ply = 0; ply < Position::UNDO_CAPACITY + 100; ++ply) {
+        played.makeMove(moveFromSan(played, shuffle[ply % 4]));
+    }
+    Position copy = played;
+    failures += copy.undoDepth() != Position::UNDO_CAPACITY || !copy.isRepetition(2) ? 1 : 0;
+    while (copy.undoDepth() > 0) {
+        copy.unmakeMove();
+        played.unmakeMove();
+        failures += copy.key() != played.key() || copy.key() != copy.computeKey() ? 1 : 0;
+    }
+
+    const int rounds = 200000;
+    int tally = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < count; ++i) {
+            tally += positionStatus(positions[i]);
+        }
+    }
+    double seconds = secondsSince(start);
+    std::printf("status test: %d positions, %d failure(s), %.1f ns per call (%d)\n", count, failures,
+        seconds * 1e9 / (double(rounds) * count), tally & 1);
+    return failures;
+}
+
+static int runSuite(uint64_t maxNodes) {
+    const uint64_t checkNodes = 5000000;
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    auto suiteStart = std::chrono::steady_clock::now();
+
+    for (const PerftCase& test : referenceCases) {
+        if (test.nodes > maxNodes) {
+            continue;
+        }
+        Position position;
+        position.setFromFen(test.fen);
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(position, test.depth);
+        double seconds = secondsSince(start);
+        totalNodes += nodes;
+
+        bool ok = nodes == test.nodes;
+        failures += ok ? 0 : 1;
+        std::printf("%-10s depth %d  %12llu  %s  %10.0f nps\n", test.name, test.depth,
+            static_cast<unsigned long long>(nodes), ok ? "ok  " : "FAIL", seconds > 0 ? nodes / seconds : 0.0);
+        if (!ok) {
+            std::printf("           expected %llu\n", static_cast<unsigned long long>(test.nodes));
+        }
+
+        if (test.nodes <= checkNodes) {
+            uint64_t bad = consistencyErrors(position, test.depth);
+            if (bad != 0) {
+                ++failures;
+                std::printf("           %llu key or legal-move mismatch(es)\n", static_cast<unsigned long long>(bad));
+            }
+        }
+    }
+    failures += runStatusChecks();
+
+    double seconds = secondsSince(suiteStart);
+    std::printf("\n%llu nodes in %.3f s, %.0f nps, %d failure(s)\n", static_cast<unsigned long long>(totalNodes), seconds,
+        seconds > 0 ? totalNodes / seconds : 0.0, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    if (argc >= 2 && std::string(argv[1]) == "--suite") {
+        uint64_t maxNodes = argc >= 3 ? std::strtoull(argv[2], nullptr, 10) : UINT64_MAX;
+        return runSuite(maxNodes);
+    }
+
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: perft <depth> [fen]\n       perft --suite [max-nodes]\n");
+        return 2;
+    }
+
+    int depth = std::atoi(argv[1]);
+    if (depth < 1) {
+        std::fprintf(stderr, "depth must be at least 1\n");
+        return 2;
+    }
+
+    // The FEN may arrive as one quoted argument or as its six separate fields
+    std::string fen;
+    for (int i = 2; i < argc; ++i) {
+        fen += (i > 2 ? " " : "") + std::string(argv[i]);
+    }
+    return runDivide(depth, fen.empty() ? startFen : fen);
+}
@@ -0,0 +1,201 @@
+// PGN import benchmark and round-trip check.
+//
+//   pgnbench <file>              read every game of a PGN file through the
+//                                memory-mapped reader, report games per minute
+//   pgnbench --selftest [games]  write random games as PGN, check that every
+//                                move reads back unchanged, then time reading
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MoveGen.h"
+#include "Pgn.h"
+#include "SelfTest.h"
+
+// Hand-written game exercising the parts of the grammar the writer never
+// produces: comments, nested variations, glyphs, escapes and zero castling
+static const char* const annotatedGame =
+    "[Event \"Annotated \\\"test\\\"\"]\n"
+    "[White \"White\"]\n"
+    "[Black \"Black\"]\n"
+    "[Result \"1-0\"]\n"
+    "\n"
+    "% an escaped line with a stray ( and {\n"
+    "1.e4 e5 2. Nf3 {main line; with (brackets)} Nc6 (2... d6 3. d4 (3. Bc4 Be7) exd4 $1) 3.Bb5 a6\n"
+    "4. Ba4 Nf6 5. 0-0 Be7 ; to the end of the line (ignored\n"
+    "6. Re1 b5!? 7. Bb3 d6 8. c3 O-O 9. h3 Nb8 10. d4 Nbd7 $14 11. c4 c6 12. cxb5 axb5 13. Nc3 Bb7\n"
+    "14. Bg5 b4 15. Nb1 h6 16. Bh4 c5 17. dxe5 Nxe4 18. Bxe7 Qxe7 19. exd6 Qf6 20. Nbd2 Nxd6\n"
+    "21. Nc4 Nxc4 22. Bxc4 Nb6 23. Ne5 Rae8 24. Bxf7+ Rxf7 25. Nxf7 Rxe1+ 26. Qxe1 Kxf7\n"
+    "27. Qe3 Qg5 28. Qxg5 hxg5 29. b3 Ke6 30. a3 Kd6 31. axb4 cxb4 32. Ra5 Nd5 33. f3 Bc8\n"
+    "34. Kf2 Bf5 35. Ra7 g6 36. Ra6+ Kc5 37. Ke1 Nf4 38. g3 Nxh3 39. Kd2 Kb5 40. Rd6 Kc5\n"
+    "41. Ra6 Nf2 42. g4 Bd3 43. Re6 1-0\n"
+    "\n"
+    "[Event \"No result\"]\n"
+    "\n"
+    "1. d4 d5 2. c4 e6\n"
+    "[Event \"Next\"]\n"
+    "\n"
+    "1. e4 *\n";
+
+struct ReadTotals {
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    uint64_t failed = 0;
+    Key checksum = 0;
+};
+
+static ReadTotals readAll(std::string_view text) {
+    ReadTotals totals;
+    PgnReader reader(text);
+    while (reader.nextGame()) {
+        Move m;
+        while (reader.nextMove(m)) {
+            ++totals.plies;
+        }
+        ++totals.games;
+        totals.failed += reader.failed() ? 1 : 0;
+        totals.checksum ^= reader.position().key();
+    }
+    return totals;
+}
+
+static void reportThroughput(size_t bytes, const ReadTotals& totals, double seconds) {
+    std::printf("%llu games, %llu plies, %.1f MB in %.3f s: %.0f games/min, %.0f plies/s, %.0f MB/s\n",
+        static_cast<unsigned long long>(totals.games), static_cast<unsigned long long>(totals.plies), bytes / 1e6, seconds,
+        seconds > 0 ? totals.games * 60 / seconds : 0.0, seconds > 0 ? totals.plies / seconds : 0.0,
+        seconds > 0 ? bytes / 1e6 / seconds : 0.0);
+}
+
+static int runFile(const char* path) {
+    MappedFile file;
+    if (!file.open(path, SEQUENTIAL_ACCESS)) {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ReadTotals totals = readAll(file.text());
+    reportThroughput(file.size(), totals, secondsSince(start));
+    std::printf("%llu game(s) with an unreadable move, key checksum %016llx\n",
+        static_cast<unsigned long long>(totals.failed), static_cast<unsigned long long>(totals.checksum));
+    return 0;
+}
+
+static int checkAnnotated() {
+    PgnReader reader(annotatedGame);
+    int failures = 0;
+
+    int plies = 0;
+    Move m;
+    if (!reader.nextGame() || reader.tag("Event") != "Annotated \\\"test\\\"" || reader.tag("White") != "White") {
+        ++failures;
+    }
+    while (reader.nextMove(m)) {
+        ++plies;
+    }
+    if (plies != 85 || reader.failed() || reader.result() != "1-0") {
+        std::printf("annotated game: %d plies, result '%.*s'%s\n", plies, int(reader.result().size()),
+            reader.result().data(), reader.failed() ? ", failed" : "");
+        ++failures;
+    }
+
+    plies = 0;
+    if (!reader.nextGame() || reader.tag("Event") != "No result") {
+        ++failures;
+    }
+    while (reader.nextMove(m)) {
+        ++plies;
+    }
+    if (plies != 4 || !reader.result().empty()) {
+        ++failures;
+    }
+
+    // The third game is left unread and must still be skipped cleanly
+    if (!reader.nextGame() || reader.tag("Event") != "Next" || reader.nextGame()) {
+        ++failures;
+    }
+    if (failures) {
+        std::printf("annotated sample: %d failure(s)\n", failures);
+    }
+    return failures;
+}
+
+static int runSelfTest(int games) {
+    TestRandom random;
+
+    std::ostringstream out;
+    std::vector<std::vector<Move>> played;
+    std::vector<Key> finalKeys;
+    std::vector<PgnTag> tags = { { "Event", "Self test" }, { "Site", "?" }, { "Date", "????.??.??" },
+        { "Round", "-" }, { "White", "Random" }, { "Black", "Random" }, { "Result", "*" } };
+
+    for (int i = 0; i < games; ++i) {
+        Position start;
+        start.setFromFen(seedFens[i % SEED_FEN_COUNT]);
+        RandomGame game = randomGame(start, 300, random);
+        const std::vector<Move>& moves = game.moves;
+        tags.front().value = "Self test " + std::to_string(i + 1);
+        writePgn(out, tags, start, moves, "*");
+        played.push_back(moves);
+        finalKeys.push_back(game.end.key());
+    }
+    std::string text = out.str();
+
+    int failures = checkAnnotated();
+    uint64_t plies = 0;
+    PgnReader reader(text);
+    for (int game = 0; game < games; ++game) {
+        const std::vector<Move>& moves = played[game];
+        bool ok = reader.nextGame() && reader.tag("Event") == "Self test " + std::to_string(game + 1);
+        size_t count = 0;
+        Move m;
+        while (ok && reader.nextMove(m)) {
+            ok = count < moves.size() && moves[count] == m;
+            ++count;
+        }
+        ok = ok && count == moves.size() && !reader.failed() && reader.result() == "*"
+            && reader.position().key() == finalKeys[game];
+        plies += count;
+        if (!ok && ++failures <= 10) {
+            std::printf("game %d did not read back after %zu plies\n", game + 1, count);
+        }
+    }
+    if (reader.nextGame()) {
+        ++failures;
+    }
+    std::printf("%d games, %llu plies round-tripped, %d failure(s)\n", games, static_cast<unsigned long long>(plies),
+        failures);
+
+    // Time reading alone over the text a few times to smooth out noise
+    const int passes = 3;
+    ReadTotals totals;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        ReadTotals one = readAll(text);
+        totals.games += one.games;
+        totals.plies += one.plies;
+    }
+    reportThroughput(text.size() * passes, totals, secondsSince(start));
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    if (argc >= 2 && std::string(argv[1]) == "--selftest") {
+        int games = argc >= 3 ? std::atoi(argv[2]) : 1000;
+        return runSelfTest(games < 1 ? 1 : games);
+    }
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: pgnbench <file>\n       pgnbench --selftest [games]\n");
+        return 2;
+    }
+    return runFile(argv[1]);
+}
@@ -0,0 +1,270 @@
+// Polyglot opening book tool.
+//
+//   polybook build <in.pgn> <out.bin> [threads] [max-ply] [min-games]
+//                               build a book from a PGN collection
+//   polybook probe <book.bin> [fen]
+//                               list the book moves of a position (the start
+//                               by default) with their weights
+//   polybook --selftest [games] check keys against the Polyglot reference and
+//                               move codes, then build a book from random
+//                               games and probe every position
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MoveGen.h"
+#include "Notation.h"
+#include "Pgn.h"
+#include "Polyglot.h"
+#include "SelfTest.h"
+
+static const char* const startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static int runBuild(const char* pgnPath, const char* bookPath, int threads, int maxPly, int minGames) {
+    MappedFile pgn;
+    if (!pgn.open(pgnPath, SEQUENTIAL_ACCESS)) {
+        std::fprintf(stderr, "cannot open %s\n", pgnPath);
+        return 2;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!buildBook(pgn.text(), bookPath, threads, maxPly, minGames)) {
+        std::fprintf(stderr, "cannot write %s\n", bookPath);
+        return 2;
+    }
+    OpeningBook book;
+    book.open(bookPath);
+    std::printf("%zu entries built on %d thread(s) in %.3f s\n", book.size(), threads, secondsSince(start));
+    return 0;
+}
+
+static int runProbe(const char* path, const std::string& fen) {
+    OpeningBook book;
+    Position position;
+    if (!book.open(path)) {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+    if (!position.setFromFen(fen)) {
+        std::fprintf(stderr, "invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+
+    BookEntry entries[OpeningBook::MAX_BOOK_MOVES];
+    int found = book.probe(position, entries, OpeningBook::MAX_BOOK_MOVES);
+    uint64_t total = 0;
+    for (int i = 0; i < found; ++i) {
+        total += entries[i].weight;
+    }
+    std::printf("key %016llx, %d book move(s)\n", static_cast<unsigned long long>(polyglotKey(position)), found);
+    for (int i = 0; i < found; ++i) {
+        Move m = moveFromPolyglot(position, entries[i].move);
+        std::printf("  %-8s weight %5u  %5.1f%%\n", moveToSan(position, m).c_str(), entries[i].weight,
+            total ? 100.0 * entries[i].weight / total : 0.0);
+    }
+    return 0;
+}
+
+// Keys given in the Polyglot format description, each after one more move
+// from the start
+static const char* const referenceMoves[] = { "e4", "d5", "e5", "f5", "Ke2", "Kf7" };
+static const Key referenceKeys[] = {
+    0x463B96181691FC9CULL,
+    0x823C9B50FD114196ULL,
+    0x0756B94461C50FB0ULL,
+    0x662FAFB965DB29D4ULL,
+    0x22A48B5A8E47FF78ULL,
+    0x652A607CA3F242C1ULL,
+    0x00FDD303C946BDD9ULL,
+};
+
+static int checkReferenceKeys() {
+    int failures = 0;
+    Position position;
+    position.setStartPosition();
+    for (size_t i = 0; i < sizeof(referenceKeys) / sizeof(referenceKeys[0]); ++i) {
+        if (i > 0) {
+            position.makeMove(moveFromSan(position, referenceMoves[i - 1]));
+        }
+        if (polyglotKey(position) != referenceKeys[i]) {
+            ++failures;
+            std::printf("key after %zu move(s) is %016llx, expected %016llx\n", i,
+                static_cast<unsigned long long>(polyglotKey(position)), static_cast<unsigned long long>(referenceKeys[i]));
+        }
+    }
+
+    // Two more from the description, the first with an en-passant file
+    static const struct {
+        const char* fen;
+        Key key;
+    } fens[] = {
+        { "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3C8123EA7B067637ULL },
+        { "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5C3F9B829B279560ULL },
+    };
+    for (const auto& reference : fens) {
+        position.setFromFen(reference.fen);
+        if (polyglotKey(position) != reference.key) {
+            ++failures;
+            std::printf("key of %s is %016llx, expected %016llx\n", reference.fen,
+                static_cast<unsigned long long>(polyglotKey(position)), static_cast<unsigned long long>(reference.key));
+        }
+    }
+    return failures;
+}
+
+static int checkMoveCodes() {
+    static const char* const fens[] = {
+        startFen,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    };
+    int failures = 0;
+    for (const char* fen : fens) {
+        Position position;
+        position.setFromFen(fen);
+        MoveList moves;
+        generateMoves(position, moves);
+        for (Move m : moves) {
+            if (moveFromPolyglot(position, moveToPolyglot(m)) != m) {
+                ++failures;
+            }
+        }
+    }
+
+    // Castling is written as the king taking its own rook
+    if (moveToPolyglot(makeMove(E1, G1, KING_CASTLE)) != (7 | (0 << 3) | (4 << 6) | (0 << 9))
+        || moveToPolyglot(makeMove(E8, C8, QUEEN_CASTLE)) != (0 | (7 << 3) | (4 << 6) | (7 << 9))) {
+        ++failures;
+    }
+
+    // Transposed move orders reach the same key; the side to move and the
+    // castling rights are part of it
+    Position a, b, c;
+    a.setFromFen("rnbqkb1r/pppppppp/5n2/8/8/2N2N2/PPPPPPPP/R1BQKB1R b KQkq - 3 2");
+    b.setStartPosition();
+    for (const char* san : { "Nc3", "Nf6", "Nf3" }) {
+        b.makeMove(moveFromSan(b, san));
+    }
+    c.setFromFen("rnbqkb1r/pppppppp/5n2/8/8/2N2N2/PPPPPPPP/R1BQKB1R w KQkq - 3 2");
+    failures += polyglotKey(a) != polyglotKey(b) ? 1 : 0;
+    failures += polyglotKey(a) == polyglotKey(c) ? 1 : 0;
+    c.setFromFen("rnbqkb1r/pppppppp/5n2/8/8/2N2N2/PPPPPPPP/R1BQKB1R b Kkq - 3 2");
+    failures += polyglotKey(a) == polyglotKey(c) ? 1 : 0;
+
+    if (failures) {
+        std::printf("move code and key checks: %d failure(s)\n", failures);
+    }
+    return failures;
+}
+
+static int runSelfTest(int games) {
+    const char* const path = "polybook-selftest.bin";
+    const int maxPly = 12;
+    TestRandom random;
+
+    // Short games with few choices per move, so positions recur, and the
+    // points each move should be credited with
+    std::map<std::pair<Key, uint16_t>, uint32_t> expected;
+    std::ostringstream pgn;
+    static const char* const results[] = { "1-0", "0-1", "1/2-1/2" };
+    for (int i = 0; i < games; ++i) {
+        const char* result = results[i % 3];
+        int whitePoints = i % 3 == 0 ? 2 : i % 3 == 1 ? 0 : 1;
+        Position start;
+        start.setStartPosition();
+        std::vector<Move> moves = randomGame(start, 20, random, 3).moves;
+        Position position = start;
+        for (size_t ply = 0; ply < moves.size() && ply < size_t(maxPly); ++ply) {
+            int points = position.sideToMove() == WHITE ? whitePoints : 2 - whitePoints;
+            expected[{ polyglotKey(position), moveToPolyglot(moves[ply]) }] += uint32_t(points);
+            position.makeMove(moves[ply]);
+        }
+        writePgn(pgn, { { "Event", "Self test" }, { "Result", result } }, start, moves, result);
+    }
+
+    // Books from other programs are unreadable without the published keys,
+    // so nothing else is worth checking when they are wrong
+    if (checkReferenceKeys() > 0) {
+        std::printf("keys do not match the Polyglot reference\n");
+        return 1;
+    }
+    int failures = checkMoveCodes();
+    std::string text = pgn.str();
+    OpeningBook book;
+    if (!buildBook(text, path, 3, maxPly) || !book.open(path)) {
+        std::printf("book was not built\n");
+        std::remove(path);
+        return 1;
+    }
+
+    // Every move that scored is in the book with its points as weight
+    size_t kept = 0;
+    for (const auto& [entry, points] : expected) {
+        kept += points > 0 ? 1 : 0;
+    }
+    failures += book.size() != kept ? 1 : 0;
+
+    Position position;
+    position.setStartPosition();
+    for (int i = 0; i < games; ++i) {
+        Position walk = position;
+        for (int ply = 0; ply < maxPly; ++ply) {
+            BookEntry entries[OpeningBook::MAX_BOOK_MOVES];
+            int found = book.probe(walk, entries, OpeningBook::MAX_BOOK_MOVES);
+            Key key = polyglotKey(walk);
+            for (int e = 0; e < found; ++e) {
+                auto it = expected.find({ key, entries[e].move });
+                if (it == expected.end() || it->second != entries[e].weight) {
+                    ++failures;
+                }
+            }
+            Move m = book.pick(walk, random());
+            if (m == NO_MOVE) {
+                break;
+            }
+            walk.makeMove(m);
+        }
+    }
+    std::printf("%d games, %zu book entries checked, %d failure(s)\n", games, book.size(), failures);
+
+    book.close();
+    std::remove(path);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    std::string command = argc >= 2 ? argv[1] : "";
+    if (command == "--selftest") {
+        int games = argc >= 3 ? std::atoi(argv[2]) : 3000;
+        return runSelfTest(games < 1 ? 1 : games);
+    }
+    if (command == "build" && argc >= 4 && argc <= 7) {
+        unsigned cores = std::thread::hardware_concurrency();
+        int threads = argc >= 5 ? std::atoi(argv[4]) : cores > 0 ? int(cores) : 1;
+        int maxPly = argc >= 6 ? std::atoi(argv[5]) : 30;
+        int minGames = argc >= 7 ? std::atoi(argv[6]) : 1;
+        return runBuild(argv[2], argv[3], threads < 1 ? 1 : threads, maxPly, minGames);
+    }
+    if (command == "probe" && argc >= 3) {
+        std::string fen;
+        for (int i = 3; i < argc; ++i) {
+            fen += (i > 3 ? " " : "") + std::string(argv[i]);
+        }
+        return runProbe(argv[2], fen.empty() ? startFen : fen);
+    }
+    std::fprintf(stderr,
+        "usage: polybook build <in.pgn> <out.bin> [threads] [max-ply] [min-games]\n"
+        "       polybook probe <book.bin> [fen]\n"
+        "       polybook --selftest [games]\n");
+    return 2;
+}
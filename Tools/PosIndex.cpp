@@ -0,0 +1,266 @@
+// Position index tool for opening-explorer queries over a game archive.
+//
+//   posindex build <games.cga> <out.cpi> [threads] [max-ply]
+//                                  index every position of the archive's games
+//   posindex query <index.cpi> [fen]
+//                                  show the games and continuations of a
+//                                  position (the start by default) and time lookups
+//   posindex --selftest [games]    index random games and check every lookup
+//                                  against a brute-force count, then check
+//                                  that damaged copies of the index are refused
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MoveGen.h"
+#include "Notation.h"
+#include "PositionIndex.h"
+#include "SelfTest.h"
+
+static int defaultThreads() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 0 ? int(cores) : 1;
+}
+
+static int runBuild(const char* archivePath, const char* indexPath, int threads, int maxPly) {
+    GameArchive archive;
+    if (!archive.open(archivePath)) {
+        std::fprintf(stderr, "cannot open %s or it is not a game archive\n", archivePath);
+        return 2;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!buildPositionIndex(archive, indexPath, threads, maxPly)) {
+        std::fprintf(stderr, "cannot build %s\n", indexPath);
+        return 2;
+    }
+    PositionIndex index;
+    index.open(indexPath);
+    std::printf("%llu games, %llu positions indexed on %d thread(s) in %.3f s\n",
+        static_cast<unsigned long long>(archive.size()), static_cast<unsigned long long>(index.positions()), threads,
+        secondsSince(start));
+    return 0;
+}
+
+static void printPosition(const Position& position, const IndexedPosition& found) {
+    std::printf("%u game(s)\n", found.gameCount);
+    Position scratch = position;
+    for (uint32_t i = 0; i < found.continuationCount; ++i) {
+        const IndexContinuation& c = found.continuations[i];
+        std::printf("  %-8s %8u  white %5.1f%%  draw %5.1f%%  black %5.1f%%\n", moveToSan(scratch, c.move).c_str(),
+            c.games, 100.0 * c.whiteWins / c.games, 100.0 * c.draws / c.games, 100.0 * c.blackWins / c.games);
+    }
+}
+
+static int runQuery(const char* path, const std::string& fen) {
+    PositionIndex index;
+    if (!index.open(path)) {
+        std::fprintf(stderr, "cannot open %s or it is not a position index\n", path);
+        return 2;
+    }
+    Position position;
+    if (!position.setFromFen(fen)) {
+        std::fprintf(stderr, "invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+
+    IndexedPosition found;
+    if (!index.find(position.key(), found)) {
+        std::printf("no indexed game reaches this position\n");
+    }
+    else {
+        printPosition(position, found);
+    }
+
+    // Time lookups of keys scattered over the whole table, mostly misses
+    const int lookups = 1000000;
+    uint64_t key = position.key(), hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i) {
+        key = key * 6364136223846793005ULL + 1442695040888963407ULL;
+        hits += index.find(key, found) ? 1 : 0;
+    }
+    double seconds = secondsSince(start);
+    std::printf("%llu positions, %.3f us per lookup\n", static_cast<unsigned long long>(index.positions()),
+        seconds * 1e6 / lookups);
+    return hits > lookups ? 1 : 0;
+}
+
+// Write the bytes as an index and report whether it opens
+static bool opensAsIndex(const std::string& bytes, const char* path) {
+    FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fclose(file);
+    PositionIndex index;
+    return index.open(path);
+}
+
+// Copies of a good index with one kind of damage each: a truncated file and
+// a directory pointing past the records are refused by open(), and a record
+// whose ranges run past the sections makes find() report the position missing
+static int checkDamaged(const char* indexPath) {
+    const char* const damagedPath = "posindex-selftest-damaged.cpi";
+    std::string bytes;
+    FILE* file = std::fopen(indexPath, "rb");
+    if (!file) {
+        return 1;
+    }
+    char chunk[1 << 16];
+    size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        bytes.append(chunk, got);
+    }
+    std::fclose(file);
+
+    IndexFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    size_t directoryBytes = ((size_t(1) << header.bucketBits) + 1) * sizeof(uint32_t);
+    size_t positionsOffset = sizeof(header) + (directoryBytes + 7) / 8 * 8;
+
+    int failures = 0;
+    failures += opensAsIndex(bytes.substr(0, bytes.size() - sizeof(uint32_t)), damagedPath) ? 1 : 0;
+
+    std::string damaged = bytes;
+    uint32_t pastEnd = uint32_t(header.positionCount + 1);
+    std::memcpy(&damaged[sizeof(header) + sizeof(uint32_t)], &pastEnd, sizeof(pastEnd));
+    failures += opensAsIndex(damaged, damagedPath) ? 1 : 0;
+
+    damaged = bytes;
+    IndexPosition first;
+    std::memcpy(&first, &damaged[positionsOffset], sizeof(first));
+    first.firstGame = UINT32_MAX;
+    std::memcpy(&damaged[positionsOffset], &first, sizeof(first));
+    PositionIndex index;
+    IndexedPosition found;
+    if (!opensAsIndex(damaged, damagedPath) || !index.open(damagedPath) || index.find(first.key, found)) {
+        ++failures;
+    }
+    index.close();
+    std::remove(damagedPath);
+
+    if (failures) {
+        std::printf("damaged index checks: %d failure(s)\n", failures);
+    }
+    return failures;
+}
+
+static int runSelfTest(int games) {
+    const char* const archivePath = "posindex-selftest.cga";
+    const char* const indexPath = "posindex-selftest.cpi";
+    TestRandom random;
+
+    // Short games from the start position, with few choices per move so
+    // that openings repeat and positions are shared between games
+    struct Expected {
+        std::set<uint32_t> games;
+        std::map<Move, std::set<uint32_t>> moves;
+    };
+    std::map<Key, Expected> expected;
+    GameArchiveWriter writer;
+    if (!writer.open(archivePath)) {
+        std::fprintf(stderr, "cannot create %s\n", archivePath);
+        return 2;
+    }
+    for (int i = 0; i < games; ++i) {
+        Position start;
+        start.setStartPosition();
+        int length = int(random() % 40);
+        std::vector<Move> moves = randomGame(start, length, random, 3).moves;
+        Position position = start;
+        for (size_t ply = 0;; ++ply) {
+            Expected& entry = expected[position.key()];
+            entry.games.insert(uint32_t(i));
+            if (ply == moves.size()) {
+                break;
+            }
+            entry.moves[moves[ply]].insert(uint32_t(i));
+            position.makeMove(moves[ply]);
+        }
+        ArchiveGameHeader info = {};
+        info.result = GameResult(i % 4);
+        writer.add(info, start, moves);
+    }
+    writer.close();
+
+    int failures = 0;
+    GameArchive archive;
+    PositionIndex index;
+    if (!archive.open(archivePath) || !buildPositionIndex(archive, indexPath, 3) || !index.open(indexPath)
+        || index.positions() != expected.size()) {
+        std::printf("index was not built with %zu positions\n", expected.size());
+        ++failures;
+    }
+
+    for (const auto& [key, entry] : expected) {
+        IndexedPosition found;
+        bool ok = index.find(key, found) && found.gameCount == entry.games.size()
+            && found.continuationCount == entry.moves.size()
+            && std::equal(entry.games.begin(), entry.games.end(), found.games);
+        uint32_t i = 0;
+        for (const auto& [move, players] : entry.moves) {
+            if (!ok) {
+                break;
+            }
+            const IndexContinuation& c = found.continuations[i++];
+            uint32_t white = 0, draws = 0, black = 0;
+            for (uint32_t game : players) {
+                white += GameResult(game % 4) == WHITE_WINS ? 1 : 0;
+                draws += GameResult(game % 4) == DRAWN ? 1 : 0;
+                black += GameResult(game % 4) == BLACK_WINS ? 1 : 0;
+            }
+            ok = c.move == move && c.games == players.size() && c.whiteWins == white && c.draws == draws
+                && c.blackWins == black;
+        }
+        if (!ok && ++failures <= 10) {
+            std::printf("position %016llx did not match\n", static_cast<unsigned long long>(key));
+        }
+    }
+    IndexedPosition missing;
+    failures += index.find(0x0123456789ABCDEFULL, missing) ? 1 : 0;
+    failures += checkDamaged(indexPath);
+    std::printf("%d games, %zu positions checked, %d failure(s)\n", games, expected.size(), failures);
+
+    index.close();
+    archive.close();
+    std::remove(indexPath);
+    std::remove(archivePath);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    std::string command = argc >= 2 ? argv[1] : "";
+    if (command == "--selftest") {
+        int games = argc >= 3 ? std::atoi(argv[2]) : 2000;
+        return runSelfTest(games < 1 ? 1 : games);
+    }
+    if (command == "build" && argc >= 4 && argc <= 6) {
+        int threads = argc >= 5 ? std::atoi(argv[4]) : defaultThreads();
+        int maxPly = argc >= 6 ? std::atoi(argv[5]) : 0;
+        return runBuild(argv[2], argv[3], threads < 1 ? 1 : threads, maxPly < 0 ? 0 : maxPly);
+    }
+    if (command == "query" && argc >= 3) {
+        std::string fen;
+        for (int i = 3; i < argc; ++i) {
+            fen += (i > 3 ? " " : "") + std::string(argv[i]);
+        }
+        return runQuery(argv[2], fen.empty() ? "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1" : fen);
+    }
+    std::fprintf(stderr,
+        "usage: posindex build <games.cga> <out.cpi> [threads] [max-ply]\n"
+        "       posindex query <index.cpi> [fen]\n"
+        "       posindex --selftest [games]\n");
+    return 2;
+}
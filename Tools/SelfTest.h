@@ -0,0 +1,63 @@
+#pragma once
+
+// Fixtures shared by the tools' --selftest modes and benchmarks
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "MoveGen.h"
+
+// Start positions for random games: the initial position and three of the
+// standard perft positions, between them castling, en passant and promotion
+static const char* const seedFens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+};
+
+static const int SEED_FEN_COUNT = int(sizeof(seedFens) / sizeof(seedFens[0]));
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// xorshift64*, started from the same seed in every tool so that a self
+// test plays the same games on every run
+struct TestRandom {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+    uint64_t operator()() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+};
+
+struct RandomGame {
+    std::vector<Move> moves;
+    Position end;
+};
+
+// Random legal moves from the start, up to maxPlies of them, ending early
+// at mate, stalemate or the fifty-move limit. A width above zero picks
+// each move among the first width generated only, so that short games
+// share their openings.
+inline RandomGame randomGame(const Position& start, int maxPlies, TestRandom& random, int width = 0) {
+    RandomGame game;
+    game.end = start;
+    for (int ply = 0; ply < maxPlies; ++ply) {
+        MoveList legal;
+        generateMoves(game.end, legal);
+        if (legal.size() == 0 || game.end.halfmoveClock() >= 100) {
+            break;
+        }
+        int choices = width > 0 && width < legal.size() ? width : legal.size();
+        Move m = legal.moves[random() % uint64_t(choices)];
+        game.end.makeMove(m);
+        game.moves.push_back(m);
+    }
+    return game;
+}
@@ -0,0 +1,73 @@
+// Time-to-depth benchmark for the parallel search. Each position is searched
+// to a fixed depth from an empty transposition table with every thread
+// count in turn, and the total time is compared with the single-threaded run.
+//
+//   smpbench [depth] [max-threads] [hash-mb]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "Search.h"
+
+static const char* const benchFens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    int depth = argc >= 2 ? std::atoi(argv[1]) : 12;
+    int hardware = int(std::thread::hardware_concurrency());
+    int maxThreads = argc >= 3 ? std::atoi(argv[2]) : (hardware > 0 ? hardware : 1);
+    size_t hashMb = argc >= 4 ? std::strtoull(argv[3], nullptr, 10) : 256;
+    if (depth < 1 || maxThreads < 1 || hashMb < 1) {
+        std::fprintf(stderr, "usage: smpbench [depth] [max-threads] [hash-mb]\n");
+        return 2;
+    }
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    TranspositionTable tt(hashMb);
+    SearchPool pool(tt);
+    SearchLimits limits;
+    limits.depth = depth;
+
+    std::printf("depth %d, %zu MB hash, %d hardware thread(s)\n\n", depth, tt.sizeMegabytes(), hardware);
+    std::printf("threads      time (s)     speedup        nodes          nps\n");
+
+    double baseline = 0;
+    for (int threads : threadCounts) {
+        pool.setThreads(threads);
+        double seconds = 0;
+        uint64_t nodes = 0;
+        for (const char* fen : benchFens) {
+            Position position;
+            position.setFromFen(fen);
+            tt.clear();
+
+            auto start = std::chrono::steady_clock::now();
+            SearchResult result = pool.search(position, limits);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            nodes += result.nodes;
+        }
+        if (threads == 1) {
+            baseline = seconds;
+        }
+        std::printf("%7d  %12.3f  %10.2fx  %11llu  %11.0f\n", threads, seconds, seconds > 0 ? baseline / seconds : 0.0,
+            static_cast<unsigned long long>(nodes), seconds > 0 ? nodes / seconds : 0.0);
+    }
+    return 0;
+}
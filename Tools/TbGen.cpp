@@ -0,0 +1,351 @@
+// Endgame tablebase tool.
+//
+//   tbgen generate <material> <dir> [threads]
+//                               generate the table of a signature such as KQvK
+//                               into the directory, with every smaller table
+//                               it needs that is not there yet
+//   tbgen probe <dir> <fen>     value of a position and a line of best play
+//   tbgen --selftest [positions]
+//                               generate KQvK, KRvK and KPvK with the tables
+//                               below them, then check known results, check
+//                               random positions against their moves and
+//                               short mates against the search
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "MoveGen.h"
+#include "Notation.h"
+#include "Search.h"
+#include "SelfTest.h"
+#include "Tablebase.h"
+
+static int defaultThreads() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 0 ? int(cores) : 1;
+}
+
+static void printStats(const TablebaseStats& stats) {
+    std::printf("%-8s %10llu positions  +%llu =%llu -%llu  longest mate %d plies  %d iterations  %.3f s\n",
+        stats.material.c_str(), static_cast<unsigned long long>(stats.positions),
+        static_cast<unsigned long long>(stats.wins), static_cast<unsigned long long>(stats.draws),
+        static_cast<unsigned long long>(stats.losses), stats.maxPlies, stats.iterations, stats.seconds);
+}
+
+static std::string describe(const TbResult& result) {
+    char text[64];
+    if (result.outcome == TB_DRAW) {
+        return "draw";
+    }
+    std::snprintf(text, sizeof(text), "%s, mate in %d plies", result.outcome == TB_WIN ? "win" : "loss", result.plies);
+    return text;
+}
+
+// The move that keeps the value: the quickest win, the slowest loss, or
+// any move holding the draw. NO_MOVE if the position has no moves or a
+// reply is not covered by the tables.
+static Move bestMove(const Tablebases& tablebases, Position& position) {
+    MoveList moves;
+    generateMoves(position, moves);
+    Move best = NO_MOVE;
+    int bestScore = -1000;
+    for (Move m : moves) {
+        position.makeMove(m);
+        TbResult reply;
+        bool found = tablebases.probe(position, reply);
+        position.unmakeMove();
+        if (!found) {
+            return NO_MOVE;
+        }
+        int score = reply.outcome == TB_LOSS ? 500 - reply.plies : reply.outcome == TB_WIN ? -500 + reply.plies : 0;
+        if (score > bestScore) {
+            bestScore = score;
+            best = m;
+        }
+    }
+    return best;
+}
+
+static int runGenerate(const std::string& material, const char* directory, int threads) {
+    if (canonicalMaterial(material).empty()) {
+        std::fprintf(stderr, "invalid material %s: expected a signature of up to %d pieces such as KQvK\n",
+            material.c_str(), TB_MAX_PIECES);
+        return 2;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!generateTablebase(material, directory, threads, printStats)) {
+        std::fprintf(stderr, "cannot generate %s into %s\n", material.c_str(), directory);
+        return 2;
+    }
+    std::printf("done on %d thread(s) in %.3f s\n", threads,
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return 0;
+}
+
+static int runProbe(const char* directory, const std::string& fen) {
+    Tablebases tablebases;
+    Position position;
+    if (!tablebases.open(directory)) {
+        std::fprintf(stderr, "cannot read tables from %s\n", directory);
+        return 2;
+    }
+    if (!position.setFromFen(fen)) {
+        std::fprintf(stderr, "invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+    TbResult result;
+    if (!tablebases.probe(position, result)) {
+        std::printf("%s is not covered by the tables\n", materialOf(position).c_str());
+        return 1;
+    }
+    std::printf("%s, %s to move: %s\n", materialOf(position).c_str(),
+        position.sideToMove() == WHITE ? "white" : "black", describe(result).c_str());
+
+    std::string line;
+    for (int ply = 0; ply < 200; ++ply) {
+        Move m = bestMove(tablebases, position);
+        if (m == NO_MOVE) {
+            break;
+        }
+        line += (line.empty() ? "" : " ") + moveToSan(position, m);
+        position.makeMove(m);
+        if (result.outcome == TB_DRAW && ply >= 20) {
+            break;
+        }
+    }
+    std::printf("%s\n", line.c_str());
+    return 0;
+}
+
+// A random legal placement of the given pieces
+static void randomPosition(Position& position, const std::string& material, TestRandom& random) {
+    static const char letters[] = "PNBRQK";
+    for (;;) {
+        position.clear();
+        Color side = WHITE;
+        bool ok = true;
+        for (char letter : material) {
+            if (letter == 'v') {
+                side = BLACK;
+                continue;
+            }
+            PieceType type = PieceType(std::string(letters).find(letter));
+            Square s = Square(random() % 64);
+            if (!position.isEmpty(s) || (type == PAWN && (rankOf(s) == 0 || rankOf(s) == 7))) {
+                ok = false;
+                break;
+            }
+            position.putPiece(makePiece(side, type), s);
+        }
+        position.setSideToMove(random() & 1 ? WHITE : BLACK);
+        if (ok && !position.isAttacked(position.kingSquare(~position.sideToMove()), position.sideToMove())) {
+            return;
+        }
+    }
+}
+
+// Whether a probed value agrees with the values of the position's moves
+static bool consistent(const Tablebases& tablebases, Position& position, const TbResult& result) {
+    MoveList moves;
+    generateMoves(position, moves);
+    if (moves.size() == 0) {
+        return position.inCheck() ? result.outcome == TB_LOSS && result.plies == 0 : result.outcome == TB_DRAW;
+    }
+    int quickestWin = 1000, slowestLoss = -1;
+    bool allLose = true;
+    for (Move m : moves) {
+        position.makeMove(m);
+        TbResult reply;
+        bool found = tablebases.probe(position, reply);
+        position.unmakeMove();
+        if (!found) {
+            return false;
+        }
+        if (reply.outcome == TB_LOSS) {
+            quickestWin = std::min(quickestWin, reply.plies + 1);
+        }
+        if (reply.outcome == TB_WIN) {
+            slowestLoss = std::max(slowestLoss, reply.plies + 1);
+        }
+        allLose &= reply.outcome == TB_WIN;
+    }
+    if (quickestWin < 1000) {
+        return result.outcome == TB_WIN && result.plies == quickestWin;
+    }
+    if (allLose) {
+        return result.outcome == TB_LOSS && result.plies == slowestLoss;
+    }
+    return result.outcome == TB_DRAW;
+}
+
+// Value within depth plies by searching every line: mate scores as the
+// engine's search gives them, 0 when no mate falls inside the horizon
+static int solveMate(Position& position, int depth, int ply, int alpha, int beta) {
+    MoveList moves;
+    generateMoves(position, moves);
+    if (moves.size() == 0) {
+        return position.inCheck() ? -MATE_SCORE + ply : 0;
+    }
+    if (depth == 0) {
+        return 0;
+    }
+    for (Move m : moves) {
+        position.makeMove(m);
+        int score = -solveMate(position, depth - 1, ply + 1, -beta, -alpha);
+        position.unmakeMove();
+        if (score > alpha) {
+            alpha = score;
+            if (alpha >= beta) {
+                break;
+            }
+        }
+    }
+    return alpha;
+}
+
+static int runSelfTest(int samples) {
+    const std::string directory = "tbgen-selftest";
+    std::filesystem::remove_all(directory);
+    int failures = 0;
+    int longest[3] = {};
+    const char* const materials[] = { "KQvK", "KRvK", "KPvK" };
+    for (int i = 0; i < 3; ++i) {
+        bool ok = generateTablebase(materials[i], directory, 2, [&](const TablebaseStats& stats) {
+            printStats(stats);
+            if (stats.material == materials[i]) {
+                longest[i] = stats.maxPlies;
+            }
+        });
+        if (!ok) {
+            std::printf("%s was not generated\n", materials[i]);
+            std::filesystem::remove_all(directory);
+            return 1;
+        }
+    }
+
+    // The longest mates are ten moves with the queen, sixteen with the rook
+    // and twenty-eight with the pawn, counted here from the defender's move
+    failures += longest[0] != 20 ? 1 : 0;
+    failures += longest[1] != 32 ? 1 : 0;
+    failures += longest[2] != 56 ? 1 : 0;
+
+    Tablebases tablebases;
+    if (!tablebases.open(directory) || tablebases.maxPieces() != 3) {
+        std::printf("tables were not loaded\n");
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+    struct Known {
+        const char* fen;
+        TbOutcome outcome;
+        int plies;
+    };
+    static const Known known[] = {
+        { "8/8/8/8/8/8/8/K1k5 w - - 0 1", TB_DRAW, 0 },
+        { "k7/8/1K6/8/8/8/8/6Q1 w - - 0 1", TB_WIN, 1 },
+        { "k7/8/1K6/8/8/8/8/7R b - - 0 1", TB_WIN, -1 },
+        { "k7/8/K7/P7/8/8/8/8 w - - 0 1", TB_DRAW, 0 },
+        { "k7/8/K7/P7/8/8/8/8 b - - 0 1", TB_DRAW, 0 },
+        { "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", TB_WIN, -1 },
+        { "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", TB_WIN, -1 },
+        { "8/8/8/8/8/2K5/8/k6r w - - 0 1", TB_LOSS, -1 },
+    };
+    for (const Known& k : known) {
+        Position position;
+        position.setFromFen(k.fen);
+        TbResult result;
+        bool ok = tablebases.probe(position, result);
+        // A winning side's colour is given from white's side
+        TbOutcome outcome = position.sideToMove() == WHITE ? result.outcome : TbOutcome(-result.outcome);
+        if (!ok || outcome != k.outcome || (k.plies >= 0 && result.plies != k.plies)) {
+            std::printf("%s: expected %d, got %s\n", k.fen, k.outcome, ok ? describe(result).c_str() : "no result");
+            ++failures;
+        }
+    }
+
+    // Random positions agree with their moves, and mates within a few plies
+    // with a plain search of every line
+    const int solvedPlies = 3;
+    int solved = 0;
+    TestRandom random;
+    for (int i = 0; i < samples; ++i) {
+        Position position;
+        randomPosition(position, materials[i % 3], random);
+        TbResult result;
+        if (!tablebases.probe(position, result) || !consistent(tablebases, position, result)) {
+            if (++failures <= 10) {
+                std::printf("%s does not match its moves\n", position.fen().c_str());
+            }
+            continue;
+        }
+        if (i % 10 == 0) {
+            ++solved;
+            int expected = result.outcome == TB_DRAW || result.plies > solvedPlies ? 0
+                : result.outcome == TB_WIN                                          ? MATE_SCORE - result.plies
+                                                                                    : -MATE_SCORE + result.plies;
+            int score = solveMate(position, solvedPlies, 0, -INFINITE_SCORE, INFINITE_SCORE);
+            if (score != expected && ++failures <= 10) {
+                std::printf("%s: solved %d, table %s\n", position.fen().c_str(), score, describe(result).c_str());
+            }
+        }
+    }
+    std::printf("%d random positions checked, %d solved, %d failure(s)\n", samples, solved, failures);
+
+    // The engine's search takes a mate far beyond its depth from the tables
+    Position far;
+    far.setFromFen("8/8/8/8/3k4/8/8/R6K w - - 0 1");
+    TbResult farValue;
+    TranspositionTable tt(16);
+    std::unique_ptr<Searcher> searcher(new Searcher(tt));
+    SearchLimits limits;
+    limits.depth = 4;
+    limits.tablebases = &tablebases;
+    SearchResult found = searcher->search(far, limits);
+    if (!tablebases.probe(far, farValue) || farValue.plies <= limits.depth
+        || found.score != MATE_SCORE - farValue.plies || found.tbHits == 0) {
+        std::printf("search with tables scored %d\n", found.score);
+        ++failures;
+    }
+    far.makeMove(found.bestMove);
+    TbResult after;
+    if (!tablebases.probe(far, after) || after.outcome != TB_LOSS || after.plies != farValue.plies - 1) {
+        std::printf("search with tables played %s\n", moveToUci(found.bestMove).c_str());
+        ++failures;
+    }
+
+    tablebases.close();
+    std::filesystem::remove_all(directory);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    initAttacks();
+
+    std::string command = argc >= 2 ? argv[1] : "";
+    if (command == "--selftest") {
+        int samples = argc >= 3 ? std::atoi(argv[2]) : 20000;
+        return runSelfTest(samples < 1 ? 1 : samples);
+    }
+    if (command == "generate" && (argc == 4 || argc == 5)) {
+        int threads = argc >= 5 ? std::atoi(argv[4]) : defaultThreads();
+        return runGenerate(argv[2], argv[3], threads < 1 ? 1 : threads);
+    }
+    if (command == "probe" && argc >= 4) {
+        std::string fen;
+        for (int i = 3; i < argc; ++i) {
+            fen += (i > 3 ? " " : "") + std::string(argv[i]);
+        }
+        return runProbe(argv[2], fen);
+    }
+    std::fprintf(stderr,
+        "usage: tbgen generate <material> <dir> [threads]\n"
+        "       tbgen probe <dir> <fen>\n"
+        "       tbgen --selftest [positions]\n");
+    return 2;
+}
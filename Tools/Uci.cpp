@@ -0,0 +1,296 @@
+// UCI front end: drives the same core as the GUI over stdin and stdout so
+// the engine can be run by tournament managers, analysis GUIs and batch
+// scripts without a window.
+//
+// Supported commands: uci, isready, ucinewgame, setoption (Hash, Threads, BookFile,
+// TablebasePath), position startpos|fen ... [moves ...], go (depth, movetime,
+// wtime, btime, winc, binc, movestogo, infinite), stop and quit.
+
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "Engine.h"
+#include "Notation.h"
+
+static const char* const startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static const int DefaultHashMb = 64;
+static const int MaxHashMb = 65536;
+static const int MaxThreads = 512;
+
+// Lines come from both the input loop and the engine thread
+static std::mutex outputMutex;
+
+static void send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+static std::string scoreText(int score) {
+    if (score >= MATE_BOUND) {
+        return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+    }
+    if (score <= -MATE_BOUND) {
+        return "mate -" + std::to_string((MATE_SCORE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+static std::string infoText(const SearchResult& result) {
+    uint64_t ms = uint64_t(result.seconds * 1000);
+    std::string text = "info depth " + std::to_string(result.depth) + " score " + scoreText(result.score) + " nodes "
+        + std::to_string(result.nodes) + " nps " + std::to_string(result.seconds > 0 ? uint64_t(result.nodes / result.seconds) : 0)
+        + " time " + std::to_string(ms) + " hashfull " + std::to_string(result.hashfull) + " tbhits "
+        + std::to_string(result.tbHits) + " pv";
+    for (Move m : result.pv) {
+        text += " " + moveToUci(m);
+    }
+    return text;
+}
+
+// An infinite search may end on its own, by hitting the depth cap or
+// proving a mate, but UCI only allows bestmove after "stop". The result is
+// held back until then.
+struct BestMoveGate {
+    std::mutex mutex;
+    bool infinite = false;
+    bool stopReceived = false;
+    bool holding = false;
+    Move held = NO_MOVE;
+
+    void begin(bool isInfinite) {
+        std::lock_guard<std::mutex> lock(mutex);
+        infinite = isInfinite;
+        stopReceived = false;
+        holding = false;
+    }
+
+    void finished(Move best) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (infinite && !stopReceived) {
+            held = best;
+            holding = true;
+            return;
+        }
+        sendBestMove(best);
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopReceived = true;
+        if (holding) {
+            holding = false;
+            sendBestMove(held);
+        }
+    }
+
+    static void sendBestMove(Move best) {
+        send("bestmove " + (best == NO_MOVE ? std::string("0000") : moveToUci(best)));
+    }
+};
+
+// "position startpos|fen <fen> [moves <move>...]". An illegal move ends
+// the list, leaving the position as it stood before that move.
+static void setPosition(Position& position, std::istringstream& args) {
+    std::string token, fen;
+    args >> token;
+    if (token == "startpos") {
+        fen = startFen;
+        args >> token;
+    }
+    else if (token == "fen") {
+        while (args >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+    }
+    else {
+        return;
+    }
+
+    if (!position.setFromFen(fen)) {
+        send("info string invalid fen " + fen);
+        position.setStartPosition();
+        return;
+    }
+
+    while (token == "moves" && args >> token) {
+        Move m = moveFromUci(position, token);
+        if (m == NO_MOVE) {
+            send("info string illegal move " + token);
+            return;
+        }
+        position.makeMove(m);
+        token = "moves";
+    }
+}
+
+// Spend a share of the remaining clock: an even split over the moves to
+// the next time control, or over 30 more moves in sudden death, plus most
+// of the increment, always keeping a margin for communication lag
+static int allocateTime(int remaining, int increment, int movesToGo) {
+    int share = remaining / (movesToGo > 0 ? movesToGo + 1 : 30) + increment * 3 / 4;
+    int ceiling = remaining - 50;
+    if (share > ceiling) {
+        share = ceiling;
+    }
+    return share < 10 ? 10 : share;
+}
+
+// Answer a held infinite search, then end the running search and wait for
+// its result. Afterwards nothing is searching, so the hash table, threads
+// and book may be changed, and no bestmove line is still to come.
+static void finishSearch(Engine& engine, BestMoveGate& gate) {
+    gate.stop();
+    engine.stop();
+    engine.wait();
+}
+
+static void go(Engine& engine, const Position& position, BestMoveGate& gate, std::istringstream& args) {
+    SearchLimits limits;
+    int time[COLOR_NB] = { 0, 0 };
+    int increment[COLOR_NB] = { 0, 0 };
+    int movesToGo = 0;
+    bool infinite = false;
+    bool clock = false;
+
+    std::string token;
+    while (args >> token) {
+        if (token == "infinite") {
+            infinite = true;
+        }
+        else if (token == "depth") {
+            args >> limits.depth;
+        }
+        else if (token == "movetime") {
+            args >> limits.moveTimeMs;
+        }
+        else if (token == "wtime") {
+            args >> time[WHITE];
+            clock = true;
+        }
+        else if (token == "btime") {
+            args >> time[BLACK];
+            clock = true;
+        }
+        else if (token == "winc") {
+            args >> increment[WHITE];
+        }
+        else if (token == "binc") {
+            args >> increment[BLACK];
+        }
+        else if (token == "movestogo") {
+            args >> movesToGo;
+        }
+    }
+
+    Color us = position.sideToMove();
+    if (!infinite && limits.moveTimeMs == 0 && clock) {
+        limits.moveTimeMs = allocateTime(time[us], increment[us], movesToGo);
+    }
+    if (infinite) {
+        limits.depth = MAX_PLY - 1;
+        limits.moveTimeMs = 0;
+        limits.useBook = false;
+    }
+
+    limits.onIteration = [](const SearchResult& iteration) {
+        send(infoText(iteration));
+    };
+
+    // Anything still running answers first, so bestmove lines never cross
+    finishSearch(engine, gate);
+
+    gate.begin(infinite);
+    engine.start(position, limits, [&gate](const SearchResult& result) {
+        gate.finished(result.bestMove);
+    });
+}
+
+// "setoption name <name> value <value>"
+static void setOption(Engine& engine, std::istringstream& args) {
+    std::string token, name, value;
+    args >> token;
+    while (args >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    // The value runs to the end of the line, as a file path may hold spaces
+    std::getline(args >> std::ws, value);
+
+    int number = std::atoi(value.c_str());
+    if (name == "Hash" && number >= 1 && number <= MaxHashMb) {
+        engine.setHashSize(size_t(number));
+    }
+    else if (name == "Threads" && number >= 1 && number <= MaxThreads) {
+        engine.setThreads(number);
+    }
+    else if (name == "BookFile") {
+        if (!engine.loadBook(value == "<empty>" ? "" : value)) {
+            send("info string cannot open book " + value);
+        }
+    }
+    else if (name == "TablebasePath") {
+        if (!engine.loadTablebases(value == "<empty>" ? "" : value)) {
+            send("info string cannot read tablebases from " + value);
+        }
+    }
+    else {
+        send("info string unsupported option " + name);
+    }
+}
+
+int main() {
+    initAttacks();
+
+    Engine engine(DefaultHashMb, 1);
+    BestMoveGate gate;
+    Position position;
+    position.setStartPosition();
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream args(line);
+        std::string command;
+        args >> command;
+
+        if (command == "uci") {
+            send("id name Chess");
+            send("id author Chess contributors");
+            send("option name Hash type spin default " + std::to_string(DefaultHashMb) + " min 1 max "
+                + std::to_string(MaxHashMb));
+            send("option name Threads type spin default 1 min 1 max " + std::to_string(MaxThreads));
+            send("option name BookFile type string default <empty>");
+            send("option name TablebasePath type string default <empty>");
+            send("uciok");
+        }
+        else if (command == "isready") {
+            send("readyok");
+        }
+        else if (command == "ucinewgame") {
+            finishSearch(engine, gate);
+            engine.clearHash();
+        }
+        else if (command == "setoption") {
+            finishSearch(engine, gate);
+            setOption(engine, args);
+        }
+        else if (command == "position") {
+            setPosition(position, args);
+        }
+        else if (command == "go") {
+            go(engine, position, gate, args);
+        }
+        else if (command == "stop") {
+            gate.stop();
+            engine.stop();
+        }
+        else if (command == "quit") {
+            break;
+        }
+    }
+
+    finishSearch(engine, gate);
+    return 0;
+}
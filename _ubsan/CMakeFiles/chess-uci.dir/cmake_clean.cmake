@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/chess-uci.dir/Tools/Uci.cpp.o"
+  "CMakeFiles/chess-uci.dir/Tools/Uci.cpp.o.d"
+  "chess-uci"
+  "chess-uci.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/chess-uci.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,33 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/ChessCore/Attacks.cpp" "CMakeFiles/chesscore.dir/ChessCore/Attacks.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Attacks.cpp.o.d"
+  "/root/repo/ChessCore/Engine.cpp" "CMakeFiles/chesscore.dir/ChessCore/Engine.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Engine.cpp.o.d"
+  "/root/repo/ChessCore/Evaluate.cpp" "CMakeFiles/chesscore.dir/ChessCore/Evaluate.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Evaluate.cpp.o.d"
+  "/root/repo/ChessCore/Game.cpp" "CMakeFiles/chesscore.dir/ChessCore/Game.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Game.cpp.o.d"
+  "/root/repo/ChessCore/GameArchive.cpp" "CMakeFiles/chesscore.dir/ChessCore/GameArchive.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/GameArchive.cpp.o.d"
+  "/root/repo/ChessCore/MappedFile.cpp" "CMakeFiles/chesscore.dir/ChessCore/MappedFile.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/MappedFile.cpp.o.d"
+  "/root/repo/ChessCore/MoveGen.cpp" "CMakeFiles/chesscore.dir/ChessCore/MoveGen.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/MoveGen.cpp.o.d"
+  "/root/repo/ChessCore/Notation.cpp" "CMakeFiles/chesscore.dir/ChessCore/Notation.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Notation.cpp.o.d"
+  "/root/repo/ChessCore/Pgn.cpp" "CMakeFiles/chesscore.dir/ChessCore/Pgn.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Pgn.cpp.o.d"
+  "/root/repo/ChessCore/Polyglot.cpp" "CMakeFiles/chesscore.dir/ChessCore/Polyglot.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Polyglot.cpp.o.d"
+  "/root/repo/ChessCore/Position.cpp" "CMakeFiles/chesscore.dir/ChessCore/Position.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Position.cpp.o.d"
+  "/root/repo/ChessCore/PositionIndex.cpp" "CMakeFiles/chesscore.dir/ChessCore/PositionIndex.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/PositionIndex.cpp.o.d"
+  "/root/repo/ChessCore/Search.cpp" "CMakeFiles/chesscore.dir/ChessCore/Search.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Search.cpp.o.d"
+  "/root/repo/ChessCore/Tablebase.cpp" "CMakeFiles/chesscore.dir/ChessCore/Tablebase.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/Tablebase.cpp.o.d"
+  "/root/repo/ChessCore/TranspositionTable.cpp" "CMakeFiles/chesscore.dir/ChessCore/TranspositionTable.cpp.o" "gcc" "CMakeFiles/chesscore.dir/ChessCore/TranspositionTable.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,39 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/chesscore.dir/ChessCore/Attacks.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Attacks.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Engine.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Engine.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Evaluate.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Evaluate.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Game.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Game.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/GameArchive.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/GameArchive.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/MappedFile.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/MappedFile.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/MoveGen.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/MoveGen.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Notation.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Notation.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Pgn.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Pgn.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Polyglot.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Polyglot.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Position.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Position.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/PositionIndex.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/PositionIndex.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Search.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Search.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/Tablebase.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/Tablebase.cpp.o.d"
+  "CMakeFiles/chesscore.dir/ChessCore/TranspositionTable.cpp.o"
+  "CMakeFiles/chesscore.dir/ChessCore/TranspositionTable.cpp.o.d"
+  "libchesscore.a"
+  "libchesscore.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/chesscore.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
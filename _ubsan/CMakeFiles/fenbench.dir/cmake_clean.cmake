@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/fenbench.dir/Tools/FenBench.cpp.o"
+  "CMakeFiles/fenbench.dir/Tools/FenBench.cpp.o.d"
+  "fenbench"
+  "fenbench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/fenbench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
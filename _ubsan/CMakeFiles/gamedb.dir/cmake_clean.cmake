@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gamedb.dir/Tools/GameDb.cpp.o"
+  "CMakeFiles/gamedb.dir/Tools/GameDb.cpp.o.d"
+  "gamedb"
+  "gamedb.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gamedb.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/perft.dir/Tools/Perft.cpp.o"
+  "CMakeFiles/perft.dir/Tools/Perft.cpp.o.d"
+  "perft"
+  "perft.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/perft.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
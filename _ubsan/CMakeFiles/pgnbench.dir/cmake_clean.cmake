@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pgnbench.dir/Tools/PgnBench.cpp.o"
+  "CMakeFiles/pgnbench.dir/Tools/PgnBench.cpp.o.d"
+  "pgnbench"
+  "pgnbench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pgnbench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/polybook.dir/Tools/PolyBook.cpp.o"
+  "CMakeFiles/polybook.dir/Tools/PolyBook.cpp.o.d"
+  "polybook"
+  "polybook.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/polybook.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/posindex.dir/Tools/PosIndex.cpp.o"
+  "CMakeFiles/posindex.dir/Tools/PosIndex.cpp.o.d"
+  "posindex"
+  "posindex.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/posindex.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
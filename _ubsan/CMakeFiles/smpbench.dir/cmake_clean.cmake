@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/smpbench.dir/Tools/SmpBench.cpp.o"
+  "CMakeFiles/smpbench.dir/Tools/SmpBench.cpp.o.d"
+  "smpbench"
+  "smpbench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/smpbench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
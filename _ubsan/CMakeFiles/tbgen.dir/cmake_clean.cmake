@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tbgen.dir/Tools/TbGen.cpp.o"
+  "CMakeFiles/tbgen.dir/Tools/TbGen.cpp.o.d"
+  "tbgen"
+  "tbgen.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tbgen.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,20 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_ubsan
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(perft-suite "/root/repo/_ubsan/perft" "--suite" "20000000")
+set_tests_properties(perft-suite PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;96;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(fen-roundtrip "/root/repo/_ubsan/fenbench" "--selftest" "2000")
+set_tests_properties(fen-roundtrip PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;97;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(pgn-roundtrip "/root/repo/_ubsan/pgnbench" "--selftest" "1000")
+set_tests_properties(pgn-roundtrip PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;98;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(archive-roundtrip "/root/repo/_ubsan/gamedb" "--selftest" "1000")
+set_tests_properties(archive-roundtrip PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;99;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(position-index "/root/repo/_ubsan/posindex" "--selftest" "2000")
+set_tests_properties(position-index PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;100;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(opening-book "/root/repo/_ubsan/polybook" "--selftest" "3000")
+set_tests_properties(opening-book PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;101;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(tablebases "/root/repo/_ubsan/tbgen" "--selftest" "20000")
+set_tests_properties(tablebases PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;102;add_test;/root/repo/CMakeLists.txt;0;")